@@ -34,10 +34,22 @@ bool Config::init(const std::string& config_file) {
     ConfigInfo.preview.stream_not_found_timeout = config_["preview"]["stream_not_found_timeout"].asUInt();
     ConfigInfo.preview.stream_none_reader_timeout = config_["preview"]["stream_none_reader_timeout"].asUInt();
     ConfigInfo.preview.trace_fps_print_rate = config_["preview"]["trace_fps_print_rate"].asInt();
+    ConfigInfo.preview.rtsp_demand = config_["preview"]["rtsp_demand"].asBool();
+    ConfigInfo.preview.rtmp_demand = config_["preview"]["rtmp_demand"].asBool();
+    ConfigInfo.preview.fmp4_demand = config_["preview"]["fmp4_demand"].asBool();
+    ConfigInfo.preview.hls_demand = config_["preview"]["hls_demand"].asBool();
+    ConfigInfo.preview.ts_demand = config_["preview"]["ts_demand"].asBool();
+    ConfigInfo.preview.fmp4_fragment_mode = config_["preview"].get("fmp4_fragment_mode", ConfigInfo.preview.fmp4_fragment_mode).asInt();
+    ConfigInfo.preview.fmp4_fragment_ms = config_["preview"].get("fmp4_fragment_ms", ConfigInfo.preview.fmp4_fragment_ms).asUInt();
+
+    ConfigInfo.hls.segment_duration = config_["hls"].get("segment_duration", ConfigInfo.hls.segment_duration).asUInt();
+    ConfigInfo.hls.segment_num = config_["hls"].get("segment_num", ConfigInfo.hls.segment_num).asUInt();
+    ConfigInfo.hls.part_duration = config_["hls"].get("part_duration", ConfigInfo.hls.part_duration).asFloat();
 
     ConfigInfo.network.extra_host = config_["network"]["extra_host"].asString();
     ConfigInfo.network.intra_host = config_["network"]["intra_host"].asString();
     ConfigInfo.network.epoll_size = config_["network"]["epoll_size"].asUInt();
+    ConfigInfo.network.zero_copy_min_size = config_["network"].get("zero_copy_min_size", ConfigInfo.network.zero_copy_min_size).asUInt();
     ConfigInfo.network.enabled_ipv6 = config_["network"]["enabled_ipv6"].asBool();
 
     ConfigInfo.grpc.port = config_["grpc"]["port"].asUInt();
@@ -77,6 +89,7 @@ bool Config::init(const std::string& config_file) {
     ConfigInfo.analyzer.trace_fps = config_["analyzer"]["trace_fps"].asBool();
 
     ConfigInfo.record.enabled = config_["record"]["enabled"].asBool();
+    ConfigInfo.record.memory_enabled = config_["record"].get("memory_enabled", ConfigInfo.record.memory_enabled).asBool();
     std::uint64_t memory_quota_temp = config_["record"]["memory_quota"].asUInt();
     ConfigInfo.record.memory_quota = memory_quota_temp * 1024 * 1024;
     ConfigInfo.record.time_quota = config_["record"]["time_quota"].asUInt() * 1000;
@@ -84,6 +97,9 @@ bool Config::init(const std::string& config_file) {
     ConfigInfo.record.enabled_sei_data = config_["record"]["enabled_sei_data"].asBool();
     ConfigInfo.record.storage_type = config_["record"]["storage_type"].asString();
     ConfigInfo.record.local_path = config_["record"]["local_path"].asString();
+    ConfigInfo.record.segment_duration = config_["record"].get("segment_duration", ConfigInfo.record.segment_duration).asUInt();
+    ConfigInfo.record.fragment_duration = config_["record"].get("fragment_duration", ConfigInfo.record.fragment_duration).asUInt();
+    ConfigInfo.record.flush_threads = config_["record"].get("flush_threads", ConfigInfo.record.flush_threads).asUInt();
     for(int i = 0; i < std::min((int)config_["record"]["s3"].size(), 10); i++) {
         ConfigInfo.record.s3[i].endpoint = config_["record"]["s3"][i]["endpoint"].asString();
         ConfigInfo.record.s3[i].outter_endpoint = config_["record"]["s3"][i]["outter_endpoint"].asString();
@@ -18,12 +18,35 @@ struct config_info {
         unsigned int stream_not_found_timeout;
         unsigned int stream_none_reader_timeout;
         int trace_fps_print_rate;
+        //按需转协议，为true时对应协议无人观看就不生成其数据(不占用cpu与内存)，
+        //rtsp/rtmp/fmp4/ts首个播放器到来时从共享的gop缓存补齐最近一个gop，仍然能秒开，hls首个播放器需要等待切片生成；
+        //默认false，与之前一样始终生成所有协议的数据
+        bool rtsp_demand = false;
+        bool rtmp_demand = false;
+        bool fmp4_demand = false;
+        bool hls_demand = false;
+        bool ts_demand = false;
+        //fmp4分片策略，0:每帧 1:按时长 2:每个gop 3:CMAF chunk
+        int fmp4_fragment_mode = 0;
+        //fmp4分片(CMAF chunk)时长，单位毫秒
+        unsigned int fmp4_fragment_ms = 200;
     } preview;
 
+    struct {
+        //切片时长，单位秒
+        unsigned int segment_duration = 2;
+        //m3u8中的切片个数
+        unsigned int segment_num = 3;
+        //ll-hls部分切片时长，单位秒，为0时关闭ll-hls
+        float part_duration = 0;
+    } hls;
+
     struct {
         std::string extra_host;
         std::string intra_host;
         unsigned int epoll_size;
+        //播放器单次发送不小于该字节数时使用MSG_ZEROCOPY，0则关闭
+        unsigned int zero_copy_min_size = 0;
         bool enabled_ipv6;
     } network;
 
@@ -85,9 +108,19 @@ struct config_info {
 
     struct {
         bool enabled = true;
-        std::uint64_t memory_quota;
-        std::uint32_t time_quota;
+        //是否开启内存录像(与设备录像相互独立)
+        bool memory_enabled = false;
+        //所有流内存录像的总内存上限，单位字节
+        std::uint64_t memory_quota = 100 * 1024 * 1024;
+        //每路流内存录像保留时长，单位毫秒
+        std::uint32_t time_quota = 60 * 1000;
         bool enabled_time_quota = false;
+        //录像切片时长，单位秒，切片在关键帧处结束
+        unsigned int segment_duration = 10;
+        //录像fmp4分片时长，单位毫秒
+        unsigned int fragment_duration = 1000;
+        //录像切片落盘线程个数
+        unsigned int flush_threads = 2;
         std::string storage_type;
         std::string local_path;
         bool enabled_sei_data;
@@ -8,6 +8,38 @@ extern "C" {
 #include "EventReport.h"
 #include "RPC/FlowRPCClient.h"
 
+/**
+ * 直接持有AVPacket数据引用的缓存，帧数据从解复用到各协议复用器都不再拷贝
+ */
+class BufferAVPacket : public toolkit::Buffer {
+public:
+    //接管pkt的数据引用，pkt被重置以便复用，pkt必须是引用计数的
+    BufferAVPacket(AVPacket *pkt) {
+        buf_ = pkt->buf;
+        data_ = reinterpret_cast<char*>(pkt->data);
+        size_ = pkt->size;
+        pkt->buf = nullptr;
+        av_packet_unref(pkt);
+    }
+
+    ~BufferAVPacket() override {
+        av_buffer_unref(&buf_);
+    }
+
+    char *data() const override {
+        return data_;
+    }
+
+    uint32_t size() const override {
+        return size_;
+    }
+
+private:
+    AVBufferRef *buf_ = nullptr;
+    char *data_ = nullptr;
+    uint32_t size_ = 0;
+};
+
 HTTPMP4Device::HTTPMP4Device(const DeviceInfo& info) : IDevice(info) {
 }
 
@@ -141,10 +173,12 @@ bool HTTPMP4Device::media_open() {
 
             bool b_ret = false;
 
+            //AVPacket循环复用，帧数据引用在每次循环中被BufferAVPacket接管或者释放
+            auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* ptr) {
+                av_packet_free(&ptr);
+            });
             while(thread_status_) {
-                auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* ptr) {
-                    av_packet_free(&ptr);
-                });
+                av_packet_unref(pkt.get());
                 n_ret = av_read_frame(format_ctx, pkt.get());
                 if(n_ret == AVERROR_EOF) {
                     if(play_index != device_info_.url_list.size()) {
@@ -186,19 +220,23 @@ bool HTTPMP4Device::media_open() {
                     break;
                 }
 
+                n_ret = av_packet_make_refcounted(pkt.get());
+                if(n_ret != 0) {
+                    ErrorID(this) << "av_packet_make_refcounted failed! " << ffmpeg_error(n_ret);
+                    break;
+                }
+
                 total_bytes_ += pkt->size;
                 speed_ += pkt->size;
-                
-                FrameImp::Ptr frame;
+
+                auto prefix_size = prefixSize(reinterpret_cast<const char*>(pkt->data), pkt->size);
+                auto buffer = std::make_shared<BufferAVPacket>(pkt.get());
+                Frame::Ptr frame;
                 if(codec_id == AV_CODEC_ID_H264) {
-                frame = std::make_shared<H264Frame>();
+                    frame = std::make_shared<FrameWrapper<H264FrameNoCacheAble> >(buffer, time_stamp, time_stamp, prefix_size, 0);
                 } else {
-                frame = std::make_shared<H265Frame>();
+                    frame = std::make_shared<FrameWrapper<H265FrameNoCacheAble> >(buffer, time_stamp, time_stamp, prefix_size, 0);
                 }
-                frame->_dts = time_stamp;
-                frame->_pts = frame->_dts;
-                frame->_buffer.assign((const char*)pkt->data, pkt->size);
-                frame->_prefix_size = prefixSize(reinterpret_cast<const char*>(pkt->data), pkt->size);
 
                 time_stamp += frame_interval;
 
@@ -49,6 +49,18 @@ int main(int argc, char* argv[]) {
 
     EventPollerPool::setPoolSize(ConfigInfo.network.epoll_size);
 
+    mINI::Instance()[General::kZeroCopyMinSize] = ConfigInfo.network.zero_copy_min_size;
+    mINI::Instance()[General::kRtspDemand] = ConfigInfo.preview.rtsp_demand;
+    mINI::Instance()[General::kRtmpDemand] = ConfigInfo.preview.rtmp_demand;
+    mINI::Instance()[General::kFMP4Demand] = ConfigInfo.preview.fmp4_demand;
+    mINI::Instance()[General::kHlsDemand] = ConfigInfo.preview.hls_demand;
+    mINI::Instance()[General::kTSDemand] = ConfigInfo.preview.ts_demand;
+    mINI::Instance()[General::kFMP4FragmentMode] = ConfigInfo.preview.fmp4_fragment_mode;
+    mINI::Instance()[General::kFMP4FragmentMS] = ConfigInfo.preview.fmp4_fragment_ms;
+    mINI::Instance()[Hls::kSegmentDuration] = ConfigInfo.hls.segment_duration;
+    mINI::Instance()[Hls::kSegmentNum] = ConfigInfo.hls.segment_num;
+    mINI::Instance()[Hls::kPartDuration] = ConfigInfo.hls.part_duration;
+
     std::string host = "0.0.0.0";
 
     TcpServer::Ptr rtsp_server = std::make_shared<TcpServer>();
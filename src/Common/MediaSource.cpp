@@ -302,6 +302,22 @@ void MediaSource::findAsync(const MediaInfo &info, const std::shared_ptr<TcpSess
     return findAsync_l(info, session, true, cb);
 }
 
+void MediaSource::colocateReader(const std::shared_ptr<TcpSession> &session, const EventPoller::Ptr &reader_poller, const function<void()> &cb) {
+    GET_CONFIG(bool, colocation, General::kReaderColocation);
+    if (!colocation || !reader_poller || reader_poller == session->getPoller()) {
+        cb();
+        return;
+    }
+    std::weak_ptr<TcpSession> weak_session = session;
+    session->migrateTo(reader_poller, [weak_session, cb](bool success) {
+        //迁移失败时会话不受影响，继续在原poller线程播放
+        if (!weak_session.lock()) {
+            return;
+        }
+        cb();
+    });
+}
+
 MediaSource::Ptr MediaSource::find(const string &schema, const string &vhost, const string &app, const string &id) {
     return find_l(schema, vhost, app, id, false);
 }
@@ -242,6 +242,8 @@ public:
 
     // 异步查找流
     static void findAsync(const MediaInfo &info, const std::shared_ptr<TcpSession> &session, const function<void(const Ptr &src)> &cb);
+    // 开启general.readerColocation时，把播放器迁移到直播源读取器最多的poller线程后再回调，cb总是在会话所在poller线程触发
+    static void colocateReader(const std::shared_ptr<TcpSession> &session, const EventPoller::Ptr &reader_poller, const function<void()> &cb);
     // 遍历所有流
     static void for_each_media(const function<void(const Ptr &src)> &cb);
 
@@ -30,6 +30,17 @@ MultiMuxerPrivate::MultiMuxerPrivate(const string &vhost,
     }
 
     _fmp4 = std::make_shared<FMP4MediaSourceMuxer>(vhost, app, stream);
+
+    GET_CONFIG(bool, enable_hls, General::kPublishToHls);
+    if (enable_hls) {
+        _hls = std::make_shared<HlsMediaSourceMuxer>(vhost, app, stream);
+    }
+    //hls切片与http-ts共用一个ts复用器
+    _ts = std::make_shared<TSMediaSourceMuxer>(vhost, app, stream, _hls);
+
+    if (ConfigInfo.record.memory_enabled) {
+        _recorder = std::make_shared<MemoryRecorder>(vhost, app, stream);
+    }
 }
 
 MultiMuxerPrivate::~MultiMuxerPrivate() {}
@@ -44,6 +55,19 @@ void MultiMuxerPrivate::resetTracks() {
     if (_fmp4) {
         _fmp4->resetTracks();
     }
+    if (_ts) {
+        _ts->resetTracks();
+    }
+    if (_recorder) {
+        _recorder->resetTracks();
+    }
+    _rtmp_active = false;
+    _rtsp_active = false;
+    _fmp4_active = false;
+    _ts_active = false;
+    _have_video = false;
+    _gop_overflow = false;
+    _gop_cache.clear();
 }
 
 void MultiMuxerPrivate::setMediaListener(const std::weak_ptr<MediaSourceEvent> &listener) {
@@ -57,12 +81,20 @@ void MultiMuxerPrivate::setMediaListener(const std::weak_ptr<MediaSourceEvent> &
     if (_fmp4) {
         _fmp4->setListener(listener);
     }
+    if (_hls) {
+        _hls->setListener(listener);
+    }
+    if (_ts) {
+        _ts->setListener(listener);
+    }
 }
 
 int MultiMuxerPrivate::totalReaderCount() const {
     return (_rtsp ? _rtsp->readerCount() : 0) +
            (_rtmp ? _rtmp->readerCount() : 0) +
-           (_fmp4 ? _fmp4->readerCount() : 0);
+           (_fmp4 ? _fmp4->readerCount() : 0) +
+           (_hls ? _hls->readerCount() : 0) +
+           (_ts ? _ts->readerCount() : 0);
 }
 
 
@@ -80,6 +112,9 @@ void MultiMuxerPrivate::setTrackListener(Listener *listener) {
 }
 
 void MultiMuxerPrivate::onTrackReady(const Track::Ptr &track) {
+    if (track->getTrackType() == TrackVideo) {
+        _have_video = true;
+    }
     if (_rtmp) {
         _rtmp->addTrack(track);
     }
@@ -89,24 +124,107 @@ void MultiMuxerPrivate::onTrackReady(const Track::Ptr &track) {
     if (_fmp4) {
         _fmp4->addTrack(track);
     }
+    if (_ts) {
+        _ts->addTrack(track);
+    }
+    if (_recorder) {
+        _recorder->addTrack(track);
+    }
 }
 
 bool MultiMuxerPrivate::isEnabled(){
-    return (_rtmp ? _rtmp->isEnabled() : false) ||
+    return _recorder ||
+           (_rtmp ? _rtmp->isEnabled() : false) ||
            (_fmp4 ? _fmp4->isEnabled() : false) ||
+           (_ts ? _ts->isEnabled() : false) ||
            (_rtsp ? _rtsp->isEnabled() : false);
 }
 
 void MultiMuxerPrivate::onTrackFrame(const Frame::Ptr &frame) {
-    if (_rtmp) {
-        _rtmp->inputFrame(frame);
+    GET_CONFIG(bool, rtmp_demand, General::kRtmpDemand);
+    GET_CONFIG(bool, rtsp_demand, General::kRtspDemand);
+    GET_CONFIG(bool, fmp4_demand, General::kFMP4Demand);
+    GET_CONFIG(bool, hls_demand, General::kHlsDemand);
+    GET_CONFIG(bool, ts_demand, General::kTSDemand);
+    //只有存在休眠的按需复用器时才需要gop缓存，全部在工作时不必缓存(拷贝)帧
+    auto sleeping = [](const void *muxer, bool active, bool demand) {
+        return muxer && demand && !active;
+    };
+    if (sleeping(_rtmp.get(), _rtmp_active, rtmp_demand) ||
+        sleeping(_rtsp.get(), _rtsp_active, rtsp_demand) ||
+        sleeping(_fmp4.get(), _fmp4_active, fmp4_demand) ||
+        sleeping(_ts.get(), _ts_active, ts_demand || hls_demand)) {
+        cacheGop(frame);
+    } else if (!_gop_cache.empty() || _gop_overflow) {
+        //有复用器重新休眠后从下个关键帧开始缓存
+        _gop_cache.clear();
+        _gop_overflow = false;
     }
-    if (_rtsp) {
-        _rtsp->inputFrame(frame);
+    inputFrameOnDemand(_rtmp, _rtmp_active, rtmp_demand, frame);
+    inputFrameOnDemand(_rtsp, _rtsp_active, rtsp_demand, frame);
+    inputFrameOnDemand(_fmp4, _fmp4_active, fmp4_demand, frame);
+    //hls由ts复用器驱动
+    inputFrameOnDemand(_ts, _ts_active, ts_demand || hls_demand, frame);
+    if (_recorder) {
+        _recorder->inputFrame(frame);
     }
-    if (_fmp4) {
-        _fmp4->inputFrame(frame);
+}
+
+void MultiMuxerPrivate::cacheGop(const Frame::Ptr &frame) {
+    if (!_have_video) {
+        //纯音频任意帧都可以开始，无需gop缓存
+        return;
+    }
+    auto is_gop_head = [](const Frame::Ptr &frame) {
+        return frame->getTrackType() == TrackVideo && (frame->keyFrame() || frame->configFrame());
+    };
+    if (is_gop_head(frame)) {
+        //sps/pps/idr(可能多slice)同属gop的开头，遇到新的gop开头才清空缓存
+        if (_gop_cache.empty() || !is_gop_head(_gop_cache.back())) {
+            _gop_cache.clear();
+            _gop_overflow = false;
+        }
+    } else if (_gop_cache.empty()) {
+        //尚未收到关键帧
+        return;
     }
+    if (_gop_cache.size() >= MAX_DEMAND_GOP_CACHE_SIZE) {
+        WarnL << stream_id_ << ", gop缓存溢出，按需转协议将不等待关键帧";
+        _gop_cache.clear();
+        _gop_overflow = true;
+        return;
+    }
+    _gop_cache.emplace_back(Frame::getCacheAbleFrame(frame));
+}
+
+template<typename Muxer>
+void MultiMuxerPrivate::inputFrameOnDemand(const std::shared_ptr<Muxer> &muxer, bool &active, bool demand, const Frame::Ptr &frame) {
+    if (!muxer) {
+        return;
+    }
+    if (!muxer->isEnabled()) {
+        //无人观看，休眠
+        active = false;
+        return;
+    }
+    if (active) {
+        muxer->inputFrame(frame);
+        return;
+    }
+    if (!demand || !_have_video || _gop_overflow) {
+        active = true;
+        muxer->inputFrame(frame);
+        return;
+    }
+    if (_gop_cache.empty()) {
+        //没有gop缓存，等待下个关键帧
+        return;
+    }
+    //由休眠转为工作状态，从最近的关键帧开始输入(gop缓存中已包含本帧)
+    active = true;
+    _gop_cache.for_each([&](const Frame::Ptr &frame) {
+        muxer->inputFrame(frame);
+    });
 }
 
 static string getTrackInfoStr(const TrackSource *track_src){
@@ -149,6 +267,9 @@ void MultiMuxerPrivate::onAllTrackReady() {
     if (_fmp4) {
         _fmp4->onAllTrackReady();
     }
+    if (_recorder) {
+        _recorder->onAllTrackReady();
+    }
     if (_track_listener) {
         _track_listener->onAllTrackReady();
     }
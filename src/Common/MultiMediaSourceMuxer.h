@@ -19,6 +19,12 @@
 #include "Rtsp/RtspMediaSourceMuxer.h"
 #include "Rtmp/RtmpMediaSourceMuxer.h"
 #include "Http/FMP4MediaSourceMuxer.h"
+#include "Http/HlsMediaSourceMuxer.h"
+#include "Http/TSMediaSourceMuxer.h"
+#include "Record/MemoryRecorder.h"
+
+//按需转协议时gop缓存的最大帧数
+#define MAX_DEMAND_GOP_CACHE_SIZE 512
 
 namespace mediakit{
 
@@ -48,6 +54,9 @@ private:
     void onTrackReady(const Track::Ptr & track) override;
     void onTrackFrame(const Frame::Ptr &frame) override;
     void onAllTrackReady() override;
+    void cacheGop(const Frame::Ptr &frame);
+    template<typename Muxer>
+    void inputFrameOnDemand(const std::shared_ptr<Muxer> &muxer, bool &active, bool demand, const Frame::Ptr &frame);
 
 private:
     std::string stream_id_;
@@ -55,7 +64,23 @@ private:
     RtmpMediaSourceMuxer::Ptr _rtmp;
     RtspMediaSourceMuxer::Ptr _rtsp;
     FMP4MediaSourceMuxer::Ptr _fmp4;
+    //hls切片器由_ts驱动
+    HlsMediaSourceMuxer::Ptr _hls;
+    TSMediaSourceMuxer::Ptr _ts;
+    //内存录像，不受按需转协议影响
+    MemoryRecorder::Ptr _recorder;
     std::weak_ptr<MediaSourceEvent> _listener;
+
+    //按需转协议相关，各协议复用器是否正在工作
+    bool _rtmp_active = false;
+    bool _rtsp_active = false;
+    bool _fmp4_active = false;
+    bool _ts_active = false;
+    bool _have_video = false;
+    //gop缓存溢出(关键帧间隔过大或无关键帧)
+    bool _gop_overflow = false;
+    //最近一个gop的帧，协议复用器由休眠转为工作时先输入之，从而无需等待下个关键帧
+    List<Frame::Ptr> _gop_cache;
 };
 
 class MultiMediaSourceMuxer : public MediaSourceEventInterceptor,
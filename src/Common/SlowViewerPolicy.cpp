@@ -0,0 +1,76 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "SlowViewerPolicy.h"
+#include "Common/config.h"
+#include "Util/logger.h"
+
+namespace mediakit {
+
+//暂停写socket期间需要自行判断发送超时
+static void checkSendTimeout(SocketHelper &sender, size_t bytes, uint64_t age) {
+    auto timeout_ms = sender.getSendTimeOutMS();
+    if (bytes && timeout_ms && age > timeout_ms) {
+        sender.shutdown(SockException(Err_other, "Socket send timeout"));
+    }
+}
+
+bool SlowViewerPolicy::dropPacket(SocketHelper &sender, bool is_key, uint32_t count) {
+    //积压降到阈值一半以下后，从gop开始处恢复发送
+    if (!updateCongestion(sender, is_key)) {
+        return false;
+    }
+    _drop_count += count;
+    _drop_count_once += count;
+    return true;
+}
+
+bool SlowViewerPolicy::pauseSending(SocketHelper &sender) {
+    //暂停期间不丢数据，积压降下来后随时可以恢复
+    return updateCongestion(sender, true);
+}
+
+bool SlowViewerPolicy::updateCongestion(SocketHelper &sender, bool resume_allowed) {
+    GET_CONFIG(uint32_t, drop_ms, General::kSlowViewerDropMS);
+    GET_CONFIG(uint32_t, max_kb, General::kSlowViewerMaxKB);
+    if (!drop_ms && !max_kb) {
+        //未开启拥塞策略
+        return false;
+    }
+
+    auto bytes = sender.getSendBufferBytes();
+    //发送缓存为空时，发送缓存清空计时器可能尚未重置
+    auto age = bytes ? sender.elapsedTimeAfterFlushed() : 0;
+    auto congested = [&](uint32_t scale) {
+        return (max_kb && bytes * scale > max_kb * 1024) || (drop_ms && age * scale > drop_ms);
+    };
+
+    if (!_dropping) {
+        if (!congested(1)) {
+            return false;
+        }
+        _dropping = true;
+        _drop_count_once = 0;
+        WarnL << "播放器发送拥塞，停止写socket:" << sender.get_peer_ip() << ":" << sender.get_peer_port()
+              << ", 积压:" << bytes / 1024 << "KB, " << age << "ms";
+    } else if (resume_allowed && !congested(2)) {
+        //积压降到阈值一半以下后恢复(滞回，防止频繁切换)
+        _dropping = false;
+        InfoL << "播放器发送恢复:" << sender.get_peer_ip() << ":" << sender.get_peer_port()
+              << ", 本次丢弃:" << _drop_count_once << ", 累计丢弃:" << _drop_count;
+        return false;
+    }
+
+    //拥塞期间不再写socket
+    checkSendTimeout(sender, bytes, age);
+    return true;
+}
+
+}//namespace mediakit
@@ -0,0 +1,71 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_SLOWVIEWERPOLICY_H
+#define ZLMEDIAKIT_SLOWVIEWERPOLICY_H
+
+#include <cstdint>
+#include "Network/Socket.h"
+using namespace toolkit;
+
+namespace mediakit {
+
+/**
+ * 慢速播放器拥塞策略
+ * 播放器发送缓存积压(字节数或者积压时长超过阈值)时，丢弃数据直到下一个关键帧(gop开始)，
+ * 而不是无限制缓存直到发送超时断开，这样弱网播放器可以降级播放，也不会占用过多服务器内存
+ */
+class SlowViewerPolicy {
+public:
+    SlowViewerPolicy() = default;
+    ~SlowViewerPolicy() = default;
+
+    /**
+     * 判断是否丢弃该批直播数据，请在播放器的环形缓冲读取回调中调用
+     * @param sender 播放器会话
+     * @param is_key 该批数据是否以关键帧开始
+     * @param count 该批数据包含的包个数，用于统计
+     * @return 是否丢弃
+     */
+    bool dropPacket(SocketHelper &sender, bool is_key, uint32_t count = 1);
+
+    /**
+     * 判断是否暂停发送，用于可以暂停读取而不必丢帧的播放器(例如时移播放)
+     * 积压超过阈值时暂停，降到阈值一半以下后恢复
+     * @param sender 播放器会话
+     * @return 是否暂停
+     */
+    bool pauseSending(SocketHelper &sender);
+
+    /**
+     * 获取累计丢弃的包个数
+     */
+    uint64_t getDropCount() const {
+        return _drop_count;
+    }
+
+private:
+    /**
+     * 根据发送缓存积压更新拥塞状态，超过阈值进入拥塞，降到阈值一半以下退出
+     * @param sender 播放器会话
+     * @param resume_allowed 本次是否允许退出拥塞(丢帧时只能从关键帧恢复)
+     * @return 是否处于拥塞状态
+     */
+    bool updateCongestion(SocketHelper &sender, bool resume_allowed);
+
+private:
+    bool _dropping = false;
+    uint64_t _drop_count = 0;
+    //本次拥塞丢弃的包个数
+    uint64_t _drop_count_once = 0;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_SLOWVIEWERPOLICY_H
@@ -71,8 +71,16 @@ const string kPublishToMP4 = GENERAL_FIELD"publishToMP4";
 const string kMergeWriteMS = GENERAL_FIELD"mergeWriteMS";
 const string kModifyStamp = GENERAL_FIELD"modifyStamp";
 const string kHlsDemand = GENERAL_FIELD"hls_demand";
+const string kRtspDemand = GENERAL_FIELD"rtsp_demand";
 const string kRtmpDemand = GENERAL_FIELD"rtmp_demand";
 const string kTSDemand = GENERAL_FIELD"ts_demand";
+const string kFMP4Demand = GENERAL_FIELD"fmp4_demand";
+const string kSlowViewerDropMS = GENERAL_FIELD"slowViewerDropMS";
+const string kSlowViewerMaxKB = GENERAL_FIELD"slowViewerMaxKB";
+const string kReaderColocation = GENERAL_FIELD"readerColocation";
+const string kZeroCopyMinSize = GENERAL_FIELD"zeroCopyMinSize";
+const string kFMP4FragmentMode = GENERAL_FIELD"fmp4FragmentMode";
+const string kFMP4FragmentMS = GENERAL_FIELD"fmp4FragmentMS";
 
 onceToken token([](){
     mINI::Instance()[kFlowThreshold] = 1024;
@@ -87,8 +95,16 @@ onceToken token([](){
     mINI::Instance()[kModifyStamp] = 0;
     mINI::Instance()[kMediaServerId] = makeRandStr(16);
     mINI::Instance()[kHlsDemand] = 0;
+    mINI::Instance()[kRtspDemand] = 0;
     mINI::Instance()[kRtmpDemand] = 0;
     mINI::Instance()[kTSDemand] = 0;
+    mINI::Instance()[kFMP4Demand] = 0;
+    mINI::Instance()[kSlowViewerDropMS] = 3000;
+    mINI::Instance()[kSlowViewerMaxKB] = 4 * 1024;
+    mINI::Instance()[kReaderColocation] = 0;
+    mINI::Instance()[kZeroCopyMinSize] = 0;
+    mINI::Instance()[kFMP4FragmentMode] = 0;
+    mINI::Instance()[kFMP4FragmentMS] = 200;
     mINI::Instance()["flow.event_report_interval"] = 10;
     mINI::Instance()["hksdk.wait_time"] = 800;
     mINI::Instance()["hksdk.rtsp"] = 0;
@@ -236,6 +252,8 @@ const string kFileBufSize = HLS_FIELD"fileBufSize";
 const string kFilePath = HLS_FIELD"filePath";
 // 是否广播 ts 切片完成通知
 const string kBroadcastRecordTs = HLS_FIELD"broadcastRecordTs";
+//LL-HLS部分切片时长,单位秒,为0时关闭LL-HLS
+const string kPartDuration = HLS_FIELD"partDur";
 
 onceToken token([](){
     mINI::Instance()[kSegmentDuration] = 2;
@@ -244,6 +262,7 @@ onceToken token([](){
     mINI::Instance()[kFileBufSize] = 64 * 1024;
     mINI::Instance()[kFilePath] = "./www";
     mINI::Instance()[kBroadcastRecordTs] = false;
+    mINI::Instance()[kPartDuration] = 0;
 },nullptr);
 } //namespace Hls
 
@@ -192,6 +192,18 @@ extern const string kRtspDemand;
 extern const string kRtmpDemand;
 extern const string kTSDemand;
 extern const string kFMP4Demand;
+//慢速播放器发送缓存中最老数据超过该时长(单位毫秒)后，丢弃数据直到下一个关键帧，0则不限制
+extern const string kSlowViewerDropMS;
+//慢速播放器发送缓存超过该大小(单位KB)后，丢弃数据直到下一个关键帧，0则不限制
+extern const string kSlowViewerMaxKB;
+//是否把同一直播源的播放器集中到同一个poller线程，减少跨线程切换和重复的gop缓存
+extern const string kReaderColocation;
+//播放器单次发送数据不小于该大小(单位字节)时使用MSG_ZEROCOPY零拷贝发送，0则关闭，仅linux 4.14以上支持
+extern const string kZeroCopyMinSize;
+//fmp4分片策略，0:每帧一个分片(延时最低) 1:按kFMP4FragmentMS时长切片 2:每个gop一个分片 3:CMAF chunk模式
+extern const string kFMP4FragmentMode;
+//fmp4分片(CMAF chunk)时长，单位毫秒，分片策略为1、3时有效
+extern const string kFMP4FragmentMS;
 }//namespace General
 
 
@@ -284,6 +296,8 @@ extern const string kFileBufSize;
 extern const string kFilePath;
 // 是否广播 ts 切片完成通知
 extern const string kBroadcastRecordTs;
+//LL-HLS部分切片时长,单位秒,为0时关闭LL-HLS
+extern const string kPartDuration;
 } //namespace Hls
 
 ////////////Rtp代理相关配置///////////
@@ -0,0 +1,142 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdint>
+#include "AnnexB.h"
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#include <immintrin.h>
+#define ENABLE_SSE2_SCAN
+#if defined(__GNUC__)
+//avx2通过运行时检测cpu特性启用，编译时无需-mavx2
+#define ENABLE_AVX2_SCAN
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ENABLE_NEON_SCAN
+#endif
+
+namespace mediakit {
+
+/**
+ * 标量查找00 00 01，搜索范围为[ptr, ptr + len - 3)
+ * 参考ffmpeg的做法：p[i + 2] > 1时i、i + 1、i + 2都不可能是start code起始位置，可以一次跳过3个字节
+ */
+static const uint8_t *findStartCodeScalar(const uint8_t *ptr, int len) {
+    int i = 0;
+    while (i < len - 3) {
+        if (ptr[i + 2] > 1) {
+            i += 3;
+        } else if (ptr[i + 1]) {
+            i += 2;
+        } else if (ptr[i] || ptr[i + 2] != 1) {
+            ++i;
+        } else {
+            return ptr + i;
+        }
+    }
+    return nullptr;
+}
+
+#if defined(ENABLE_SSE2_SCAN)
+static const uint8_t *findStartCodeSSE2(const uint8_t *ptr, int len) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    int i = 0;
+    //每次比较16个起始位置，需要读取i ~ i + 17，且保证其后至少还有1个字节
+    for (; i + 16 + 3 <= len; i += 16) {
+        auto b0 = _mm_loadu_si128((const __m128i *) (ptr + i));
+        auto b1 = _mm_loadu_si128((const __m128i *) (ptr + i + 1));
+        auto b2 = _mm_loadu_si128((const __m128i *) (ptr + i + 2));
+        auto hit = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+                                 _mm_cmpeq_epi8(b2, one));
+        auto mask = _mm_movemask_epi8(hit);
+        if (mask) {
+            return ptr + i + __builtin_ctz(mask);
+        }
+    }
+    return findStartCodeScalar(ptr + i, len - i);
+}
+#endif //ENABLE_SSE2_SCAN
+
+#if defined(ENABLE_AVX2_SCAN)
+__attribute__((target("avx2")))
+static const uint8_t *findStartCodeAVX2(const uint8_t *ptr, int len) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    int i = 0;
+    for (; i + 32 + 3 <= len; i += 32) {
+        auto b0 = _mm256_loadu_si256((const __m256i *) (ptr + i));
+        auto b1 = _mm256_loadu_si256((const __m256i *) (ptr + i + 1));
+        auto b2 = _mm256_loadu_si256((const __m256i *) (ptr + i + 2));
+        auto hit = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+                                    _mm256_cmpeq_epi8(b2, one));
+        uint32_t mask = _mm256_movemask_epi8(hit);
+        if (mask) {
+            return ptr + i + __builtin_ctz(mask);
+        }
+    }
+    return findStartCodeSSE2(ptr + i, len - i);
+}
+#endif //ENABLE_AVX2_SCAN
+
+#if defined(ENABLE_NEON_SCAN)
+static const uint8_t *findStartCodeNEON(const uint8_t *ptr, int len) {
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t one = vdupq_n_u8(1);
+    int i = 0;
+    for (; i + 16 + 3 <= len; i += 16) {
+        auto b0 = vld1q_u8(ptr + i);
+        auto b1 = vld1q_u8(ptr + i + 1);
+        auto b2 = vld1q_u8(ptr + i + 2);
+        auto hit = vandq_u8(vandq_u8(vceqq_u8(b0, zero), vceqq_u8(b1, zero)), vceqq_u8(b2, one));
+        //每个字节收窄为4bit，得到64bit掩码
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask) {
+            return ptr + i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+    return findStartCodeScalar(ptr + i, len - i);
+}
+#endif //ENABLE_NEON_SCAN
+
+using FindStartCodeFunc = const uint8_t *(*)(const uint8_t *ptr, int len);
+
+static FindStartCodeFunc getFindStartCodeFunc() {
+#if defined(ENABLE_AVX2_SCAN)
+    if (__builtin_cpu_supports("avx2")) {
+        return findStartCodeAVX2;
+    }
+#endif
+#if defined(ENABLE_SSE2_SCAN)
+    return findStartCodeSSE2;
+#elif defined(ENABLE_NEON_SCAN)
+    return findStartCodeNEON;
+#else
+    return findStartCodeScalar;
+#endif
+}
+
+const char *findStartCode(const char *ptr, const char *end) {
+    static auto s_find_func = getFindStartCodeFunc();
+    if (end - ptr < 4) {
+        return nullptr;
+    }
+    return (const char *) s_find_func((const uint8_t *) ptr, end - ptr);
+}
+
+void splitAnnexB(const char *ptr, int len, int prefix, std::vector<NaluSlice> &out) {
+    out.clear();
+    splitAnnexB(ptr, len, prefix, [&](const char *ptr, int len, int prefix) {
+        out.emplace_back(NaluSlice{ptr, len, prefix});
+    });
+}
+
+}//namespace mediakit
@@ -0,0 +1,85 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_ANNEXB_H
+#define ZLMEDIAKIT_ANNEXB_H
+
+#include <vector>
+
+namespace mediakit {
+
+//annexb格式的nalu
+struct NaluSlice {
+    //nalu起始位置(包含start code)
+    const char *ptr;
+    //nalu长度(包含start code)
+    int len;
+    //start code长度，3或4
+    int prefix;
+};
+
+/**
+ * 查找annexb start code(00 00 01)，只返回其后至少还有1个字节(nalu header)的start code
+ * x86_64下使用SSE2/AVX2，aarch64下使用NEON，其他平台使用标量实现
+ * @param ptr 数据起始位置
+ * @param end 数据末尾
+ * @return 00 00 01的位置，未找到返回nullptr
+ */
+const char *findStartCode(const char *ptr, const char *end);
+
+/**
+ * 逐个回调annexb数据中的nalu，每个字节只扫描一次
+ * @param ptr 数据指针
+ * @param len 数据长度
+ * @param prefix 第一个nalu的start code长度
+ * @param cb 回调函数，参数为nalu起始位置(包含start code)、nalu长度(包含start code)、start code长度
+ */
+template<typename FUNC>
+void splitAnnexB(const char *ptr, int len, int prefix, FUNC &&cb) {
+    auto start = ptr + prefix;
+    auto end = ptr + len;
+    int next_prefix;
+    while (true) {
+        auto next_start = findStartCode(start, end);
+        if (next_start) {
+            //找到下一帧
+            if (next_start > ptr && *(next_start - 1) == 0x00) {
+                //这个是00 00 00 01开头
+                next_start -= 1;
+                next_prefix = 4;
+            } else {
+                //这个是00 00 01开头
+                next_prefix = 3;
+            }
+            //记得加上本帧prefix长度
+            cb(start - prefix, next_start - start + prefix, prefix);
+            //搜索下一帧末尾的起始位置
+            start = next_start + next_prefix;
+            //记录下一帧的prefix长度
+            prefix = next_prefix;
+            continue;
+        }
+        //未找到下一帧,这是最后一帧
+        cb(start - prefix, end - start + prefix, prefix);
+        break;
+    }
+}
+
+/**
+ * 一次扫描出annexb数据中所有nalu的边界
+ * @param ptr 数据指针
+ * @param len 数据长度
+ * @param prefix 第一个nalu的start code长度
+ * @param out 输出nalu列表，会先清空
+ */
+void splitAnnexB(const char *ptr, int len, int prefix, std::vector<NaluSlice> &out);
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_ANNEXB_H
@@ -35,43 +35,8 @@ bool getAVCInfo(const string& strSps,int &iVideoWidth, int &iVideoHeight, float
     return getAVCInfo(strSps.data(),strSps.size(),iVideoWidth,iVideoHeight,iVideoFps);
 }
 
-const char *memfind(const char *buf, int len, const char *subbuf, int sublen) {
-    for (auto i = 0; i < len - sublen; ++i) {
-        if (memcmp(buf + i, subbuf, sublen) == 0) {
-            return buf + i;
-        }
-    }
-    return NULL;
-}
-
 void splitH264(const char *ptr, int len, int prefix, const std::function<void(const char *, int, int)> &cb) {
-    auto start = ptr + prefix;
-    auto end = ptr + len;
-    int next_prefix;
-    while (true) {
-        auto next_start = memfind(start, end - start, "\x00\x00\x01", 3);
-        if (next_start) {
-            //找到下一帧
-            if (*(next_start - 1) == 0x00) {
-                //这个是00 00 00 01开头
-                next_start -= 1;
-                next_prefix = 4;
-            } else {
-                //这个是00 00 01开头
-                next_prefix = 3;
-            }
-            //记得加上本帧prefix长度
-            cb(start - prefix, next_start - start + prefix, prefix);
-            //搜索下一帧末尾的起始位置
-            start = next_start + next_prefix;
-            //记录下一帧的prefix长度
-            prefix = next_prefix;
-            continue;
-        }
-        //未找到下一帧,这是最后一帧
-        cb(start - prefix, end - start + prefix, prefix);
-        break;
-    }
+    splitAnnexB(ptr, len, prefix, cb);
 }
 
 int prefixSize(const char *ptr, int len){
@@ -13,6 +13,7 @@
 
 #include "Frame.h"
 #include "Track.h"
+#include "AnnexB.h"
 #include "Util/base64.h"
 #include "Util/logger.h"
 
@@ -187,7 +188,7 @@ public:
         }
         if(type != H264Frame::NAL_B_P && type != H264Frame::NAL_IDR){
             //非I/B/P帧情况下，split一下，防止多个帧粘合在一起
-            splitH264(frame->data(), frame->size(), frame->prefixSize(), [&](const char *ptr, int len, int prefix) {
+            splitAnnexB(frame->data(), frame->size(), frame->prefixSize(), [&](const char *ptr, int len, int prefix) {
                 H264FrameInternal::Ptr sub_frame = std::make_shared<H264FrameInternal>(frame, (char *)ptr, len, prefix);
                 int sub_type = H264_TYPE(*((uint8_t *)sub_frame->data() + sub_frame->prefixSize()));
                 if(sub_type == H264Frame::NAL_B_P || sub_type == H264Frame::NAL_IDR) {
@@ -124,32 +124,47 @@ bool H264RtpDecoder::decodeRtp(const RtpPacket::Ptr &rtppack) {
             MakeFU(frame[1], fu);
             if (fu.S) {
                 //该帧的第一个rtp包  FU-A start
-                _h264frame->_buffer.assign("\x0\x0\x0\x1", 4);
-                _h264frame->_buffer.push_back(nal_suffix | fu.type);
-                _h264frame->_buffer.append((char *) frame + 2, length - 2);
-                _h264frame->_pts = rtppack->timeStamp;
+                //只引用rtp包，收到最后一个分片时再一次性拷贝到大小合适的缓存，避免逐包append导致的重复扩容
+                _fu_packets.clear();
+                _fu_packets.emplace_back(rtppack);
+                _fu_size = length - 2;
+                _fu_header = nal_suffix | fu.type;
                 //该函数return时，保存下当前sequence,以便下次对比seq是否连续
                 _lastSeq = rtppack->sequence;
-                return _h264frame->keyFrame();
+                return fu.type == H264Frame::NAL_IDR;
+            }
+
+            if (_fu_packets.empty()) {
+                //未收到FU-A start，该帧不完整
+                return false;
             }
 
             if (rtppack->sequence != _lastSeq + 1 && rtppack->sequence != 0) {
                 //中间的或末尾的rtp包，其seq必须连续(如果回环了则判定为连续)，否则说明rtp丢包，那么该帧不完整，必须得丢弃
-                _h264frame->_buffer.clear();
+                _fu_packets.clear();
                 WarnL << "rtp丢包: " << rtppack->sequence << " != " << _lastSeq << " + 1,该帧被废弃";
                 return false;
             }
 
+            _fu_packets.emplace_back(rtppack);
+            _fu_size += length - 2;
             if (!fu.E) {
                 //该帧的中间rtp包  FU-A mid
-                _h264frame->_buffer.append((char *) frame + 2, length - 2);
                 //该函数return时，保存下当前sequence,以便下次对比seq是否连续
                 _lastSeq = rtppack->sequence;
                 return false;
             }
 
             //该帧最后一个rtp包  FU-A end
-            _h264frame->_buffer.append((char *) frame + 2, length - 2);
+            _h264frame->_buffer.reserve(4 + 1 + _fu_size);
+            _h264frame->_buffer.assign("\x0\x0\x0\x1", 4);
+            _h264frame->_buffer.push_back(_fu_header);
+            _fu_packets.for_each([&](const RtpPacket::Ptr &rtp) {
+                //跳过FU indicator与FU header
+                auto offset = rtp->offset + 2;
+                _h264frame->_buffer.append(rtp->data() + offset, rtp->size() - offset);
+            });
+            _fu_packets.clear();
             _h264frame->_pts = rtppack->timeStamp;
             onGetH264(_h264frame);
             return false;
@@ -49,6 +49,10 @@ private:
     H264Frame::Ptr _h264frame;
     DtsGenerator _dts_generator;
     int _lastSeq = 0;
+    //FU-A分片相关，收齐后再合并
+    uint8_t _fu_header = 0;
+    uint32_t _fu_size = 0;
+    List<RtpPacket::Ptr> _fu_packets;
 };
 
 /**
@@ -211,11 +211,12 @@ public:
     void inputFrame(const Frame::Ptr &frame) override{
         VideoTrack::statistics_frame_rate();
         int type = H265_TYPE(*((uint8_t *)frame->data() + frame->prefixSize()));
-        if(frame->configFrame() || type == H265Frame::NAL_SEI_PREFIX){
-            splitH264(frame->data(), frame->size(), frame->prefixSize(), [&](const char *ptr, int len, int prefix){
+        if(type >= H265Frame::NAL_VPS){
+            //非VCL帧(vps/sps/pps/aud/sei等)开头时，split一下，防止多个帧粘合在一起(ps流合并后的帧通常以aud开头)
+            splitAnnexB(frame->data(), frame->size(), frame->prefixSize(), [&](const char *ptr, int len, int prefix){
                 H265FrameInternal::Ptr sub_frame = std::make_shared<H265FrameInternal>(frame, (char*)ptr, len, prefix);
                 int sub_type = H265_TYPE(*((uint8_t *)sub_frame->data() + sub_frame->prefixSize()));
-                if(!frame->configFrame() && sub_type != H265Frame::NAL_SEI_PREFIX) {
+                if(!frame->configFrame() && sub_type < H265Frame::NAL_VPS) {
                     sub_frame->raw_sei_payload_ = frame->raw_sei_payload_;
                 }
                 inputFrame_l(sub_frame);
@@ -82,33 +82,48 @@ bool H265RtpDecoder::decodeRtp(const RtpPacket::Ptr &rtppack) {
             MakeFU(frame[2], fu);
             if (fu.S) {
                 //该帧的第一个rtp包
-                _h265frame->_buffer.assign("\x0\x0\x0\x1", 4);
-                _h265frame->_buffer.push_back(fu.type << 1);
-                _h265frame->_buffer.push_back(0x01);
-                _h265frame->_buffer.append((char *) frame + 3, length - 3);
-                _h265frame->_pts = rtppack->timeStamp;
+                //只引用rtp包，收到最后一个分片时再一次性拷贝到大小合适的缓存，避免逐包append导致的重复扩容
+                _fu_packets.clear();
+                _fu_packets.emplace_back(rtppack);
+                _fu_size = length - 3;
+                _fu_type = fu.type;
                 //该函数return时，保存下当前sequence,以便下次对比seq是否连续
                 _lastSeq = rtppack->sequence;
-                return (_h265frame->keyFrame()); //i frame
+                return H265Frame::isKeyFrame(fu.type); //i frame
+            }
+
+            if (_fu_packets.empty()) {
+                //未收到第一个分片，该帧不完整
+                return false;
             }
 
             if (rtppack->sequence != _lastSeq + 1 && rtppack->sequence != 0) {
                 //中间的或末尾的rtp包，其seq必须连续(如果回环了则判定为连续)，否则说明rtp丢包，那么该帧不完整，必须得丢弃
-                _h265frame->_buffer.clear();
+                _fu_packets.clear();
                 WarnL << "rtp丢包: " << rtppack->sequence << " != " << _lastSeq << " + 1,该帧被废弃";
                 return false;
             }
 
+            _fu_packets.emplace_back(rtppack);
+            _fu_size += length - 3;
             if (!fu.E) {
                 //该帧的中间rtp包
-                _h265frame->_buffer.append((char *) frame + 3, length - 3);
                 //该函数return时，保存下当前sequence,以便下次对比seq是否连续
                 _lastSeq = rtppack->sequence;
                 return false;
             }
 
             //该帧最后一个rtp包
-            _h265frame->_buffer.append((char *) frame + 3, length - 3);
+            _h265frame->_buffer.reserve(4 + 2 + _fu_size);
+            _h265frame->_buffer.assign("\x0\x0\x0\x1", 4);
+            _h265frame->_buffer.push_back(_fu_type << 1);
+            _h265frame->_buffer.push_back(0x01);
+            _fu_packets.for_each([&](const RtpPacket::Ptr &rtp) {
+                //跳过PayloadHdr与FU header
+                auto offset = rtp->offset + 3;
+                _h265frame->_buffer.append(rtp->data() + offset, rtp->size() - offset);
+            });
+            _fu_packets.clear();
             _h265frame->_pts = rtppack->timeStamp;
             onGetH265(_h265frame);
             return false;
@@ -50,6 +50,10 @@ private:
     H265Frame::Ptr _h265frame;
     DtsGenerator _dts_generator;
     int _lastSeq = 0;
+    //FU分片相关，收齐后再合并
+    uint8_t _fu_type = 0;
+    uint32_t _fu_size = 0;
+    List<RtpPacket::Ptr> _fu_packets;
 };
 
 /**
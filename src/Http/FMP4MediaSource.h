@@ -12,22 +12,69 @@
 #define ZLMEDIAKIT_FMP4MEDIASOURCE_H
 
 #include "Common/MediaSource.h"
+#include "Http/WebSocketSplitter.h"
 using namespace toolkit;
 #define FMP4_GOP_SIZE 512
 
 namespace mediakit {
 
-//FMP4直播数据包
-class FMP4Packet : public BufferString{
+//FMP4直播数据包(一个fmp4分片)，由moof等box头与帧数据的引用组成，帧数据不拷贝；
+//所有播放器共享，ws-fmp4播放器共享其预编码的websocket帧头
+class FMP4Packet {
 public:
     using Ptr = std::shared_ptr<FMP4Packet>;
 
-    template<typename ...ARGS>
-    FMP4Packet(ARGS && ...args) : BufferString(std::forward<ARGS>(args)...) {};
-    ~FMP4Packet() override = default;
+    /**
+     * 构造函数
+     * @param segment fmp4分片，第一个片段为moof等box头，其后为帧数据
+     */
+    FMP4Packet(List<Buffer::Ptr> segment) : _payload(std::move(segment)) {
+        //box头很小，拷贝到预留了websocket帧头空间的缓存
+        auto &front = _payload.front();
+        string head;
+        head.reserve(WS_MAX_HEADER_SIZE + front->size());
+        head.resize(WS_MAX_HEADER_SIZE);
+        head.append(front->data(), front->size());
+        _payload.pop_front();
+
+        uint64_t tail_size = 0;
+        _payload.for_each([&](const Buffer::Ptr &buf) {
+            tail_size += buf->size();
+        });
+        _head = std::make_shared<WebSocketPreEncodedBuffer>(std::move(head), WebSocketHeader::BINARY, tail_size);
+        _size = _head->size() + tail_size;
+    }
+
+    ~FMP4Packet() = default;
+
+    /**
+     * 分片总长度
+     */
+    uint32_t size() const {
+        return _size;
+    }
+
+    /**
+     * 按顺序遍历分片的各个数据片段
+     * @param websocket 是否以websocket帧方式输出，是则第一个片段带上预编码的帧头
+     * @param cb 回调，参数为数据片段以及是否为最后一个片段
+     */
+    void for_each(bool websocket, const function<void(const Buffer::Ptr &buf, bool last)> &cb) {
+        cb(websocket ? WebSocketPreEncodedBuffer::getFrame(_head) : _head, _payload.empty());
+        uint64_t i = 0;
+        auto size = _payload.size();
+        _payload.for_each([&](const Buffer::Ptr &buf) {
+            cb(buf, ++i == size);
+        });
+    }
 
 public:
     uint32_t time_stamp = 0;
+
+private:
+    uint32_t _size;
+    WebSocketPreEncodedBuffer::Ptr _head;
+    List<Buffer::Ptr> _payload;
 };
 
 //FMP4直播源
@@ -121,6 +168,9 @@ private:
             }
             strong_self->onReaderChanged(size);
         });
+        //fmp4的sps/pps在init segment中，每个关键帧分片都是新gop的开头；
+        //按gop分片时连续的分片都是关键帧，合并的话gop缓存永远不会重置
+        _ring->setMergeKey(false);
         onReaderChanged(0);
         if (!_init_segment.empty()) {
             regist();
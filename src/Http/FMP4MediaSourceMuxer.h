@@ -3,6 +3,7 @@
 
 #include "Http/FMP4MediaSource.h"
 #include "Http/MP4Muxer.h"
+#include "Common/config.h"
 
 namespace mediakit {
 
@@ -15,6 +16,9 @@ public:
     FMP4MediaSourceMuxer(const string &vhost,
                                 const string &app,
                                 const string &stream_id) {
+        GET_CONFIG(int, fragment_mode, General::kFMP4FragmentMode);
+        GET_CONFIG(uint32_t, fragment_ms, General::kFMP4FragmentMS);
+        setFragmentMode((FragmentMode) fragment_mode, fragment_ms);
         _media_src = std::make_shared<FMP4MediaSource>(vhost, app, stream_id);
     }
 
@@ -30,15 +34,29 @@ public:
     }
 
     void onReaderChanged(MediaSource &sender, int size) override {
+        GET_CONFIG(bool, fmp4_demand, General::kFMP4Demand);
+        _enabled = fmp4_demand ? size : true;
+        if (!size && fmp4_demand) {
+            _clear_cache = true;
+        }
         MediaSourceEventInterceptor::onReaderChanged(sender, size);
     }
 
     void inputFrame(const Frame::Ptr &frame) override {
-        MP4MuxerMemory::inputFrame(frame);
+        GET_CONFIG(bool, fmp4_demand, General::kFMP4Demand);
+        if (_clear_cache && fmp4_demand) {
+            _clear_cache = false;
+            _media_src->clearCache();
+        }
+        if (_enabled || !fmp4_demand) {
+            MP4MuxerMemory::inputFrame(frame);
+        }
     }
 
     bool isEnabled() {
-        return true;
+        GET_CONFIG(bool, fmp4_demand, General::kFMP4Demand);
+        //缓存尚未清空时，还允许触发inputFrame函数，以便及时清空缓存
+        return fmp4_demand ? (_clear_cache ? true : _enabled) : true;
     }
 
     void onAllTrackReady() {
@@ -47,16 +65,16 @@ public:
     }
 
 protected:
-    void onSegmentData(const std::string &buf, uint32_t stamp, bool key_frame) override {
-        if (buf.empty()) {
-            return;
-        }
-        FMP4Packet::Ptr packet = std::make_shared<FMP4Packet>(std::move(buf));
+    void onSegmentData(List<Buffer::Ptr> segment, uint32_t stamp, bool key_frame) override {
+        //帧数据以引用方式保存在分片中，不拷贝
+        FMP4Packet::Ptr packet = std::make_shared<FMP4Packet>(std::move(segment));
         packet->time_stamp = stamp;
         _media_src->onWrite(std::move(packet), key_frame);
     }
 
 private:
+    bool _enabled = true;
+    bool _clear_cache = false;
     FMP4MediaSource::Ptr _media_src;
 };
 
@@ -0,0 +1,341 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+#include "HlsMediaSource.h"
+#include "Common/config.h"
+
+namespace mediakit {
+
+HlsMediaSource::HlsMediaSource(const string &vhost, const string &app, const string &stream_id)
+        : MediaSource(HLS_SCHEMA, vhost, app, stream_id) {}
+
+HlsMediaSource::~HlsMediaSource() {
+    //直播源注销后不会再有新切片
+    releaseWaiters();
+}
+
+void HlsMediaSource::setPartDuration(float part_duration) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    _part_duration = part_duration;
+}
+
+void HlsMediaSource::inputPart(Buffer::Ptr data, float duration, bool independent) {
+    bool regist_now = false;
+    bool low_latency;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        if (_segments.empty() || _segments.back()->complete) {
+            auto segment = std::make_shared<HlsSegment>();
+            segment->seq = _next_seq++;
+            _segments.emplace_back(std::move(segment));
+        }
+        _speed[TrackVideo] += data->size();
+        auto &segment = _segments.back();
+        segment->duration += duration;
+        segment->parts.emplace_back(HlsPart{std::move(data), duration, independent});
+
+        low_latency = _part_duration > 0;
+        if (low_latency) {
+            //ll-hls的m3u8包含未完成切片的部分切片
+            makePlaylist_l();
+        }
+        regist_now = !_registed;
+        _registed = true;
+    }
+
+    if (regist_now) {
+        regist();
+        onReaderChanged(0);
+    }
+    if (low_latency) {
+        onPlaylistChanged();
+    }
+}
+
+void HlsMediaSource::endSegment() {
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        if (_segments.empty() || _segments.back()->complete) {
+            return;
+        }
+        _segments.back()->complete = true;
+
+        GET_CONFIG(uint32_t, segment_num, Hls::kSegmentNum);
+        GET_CONFIG(uint32_t, segment_retain, Hls::kSegmentRetain);
+        //移出m3u8的切片继续保留一段时间，供慢速播放器下载
+        while (_segments.size() > segment_num + segment_retain) {
+            _segments.pop_front();
+        }
+        makePlaylist_l();
+    }
+    onPlaylistChanged();
+}
+
+void HlsMediaSource::clearCache() {
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        //切片序号继续递增，避免播放器误用旧切片
+        _segments.clear();
+        _playlist = nullptr;
+    }
+    releaseWaiters();
+}
+
+void HlsMediaSource::releaseWaiters() {
+    std::vector<Waiter> waiters;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        waiters.swap(_waiters);
+    }
+    for (auto &waiter : waiters) {
+        waiter.cb(nullptr);
+    }
+}
+
+static void appendFloat(string &str, const char *fmt, float value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), fmt, value);
+    str.append(buf);
+}
+
+void HlsMediaSource::makePlaylist_l() {
+    GET_CONFIG(uint32_t, segment_num, Hls::kSegmentNum);
+    bool low_latency = _part_duration > 0;
+
+    //m3u8中的切片
+    std::vector<HlsSegment::Ptr> segments;
+    HlsSegment::Ptr pending;
+    for (auto &segment : _segments) {
+        if (segment->complete) {
+            segments.emplace_back(segment);
+        } else if (low_latency) {
+            pending = segment;
+        }
+    }
+    if (segments.size() > segment_num) {
+        segments.erase(segments.begin(), segments.end() - segment_num);
+    }
+    if (segments.empty() && !pending) {
+        _playlist = nullptr;
+        return;
+    }
+
+    float max_duration = 1;
+    for (auto &segment : segments) {
+        max_duration = MAX(max_duration, segment->duration);
+    }
+
+    string m3u8;
+    m3u8.reserve(1024);
+    m3u8 += "#EXTM3U\n";
+    m3u8 += low_latency ? "#EXT-X-VERSION:6\n" : "#EXT-X-VERSION:3\n";
+    _target_duration = (int) ceil(max_duration);
+    m3u8 += "#EXT-X-TARGETDURATION:" + to_string(_target_duration) + "\n";
+    m3u8 += "#EXT-X-MEDIA-SEQUENCE:" + to_string(segments.empty() ? pending->seq : segments.front()->seq) + "\n";
+    if (low_latency) {
+        appendFloat(m3u8, "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=%.3f\n", _part_duration * 3);
+        appendFloat(m3u8, "#EXT-X-PART-INF:PART-TARGET=%.3f\n", _part_duration);
+    } else {
+        m3u8 += "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES\n";
+    }
+
+    auto append_parts = [&](const HlsSegment::Ptr &segment) {
+        for (size_t i = 0; i < segment->parts.size(); ++i) {
+            auto &part = segment->parts[i];
+            appendFloat(m3u8, "#EXT-X-PART:DURATION=%.3f,", part.duration);
+            m3u8 += "URI=\"seg_" + to_string(segment->seq) + "_" + to_string(i) + ".ts\"";
+            m3u8 += part.independent ? ",INDEPENDENT=YES\n" : "\n";
+        }
+    };
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+        auto &segment = segments[i];
+        if (low_latency && i + 3 >= segments.size()) {
+            //只列出最近几个切片的部分切片
+            append_parts(segment);
+        }
+        appendFloat(m3u8, "#EXTINF:%.3f,\n", segment->duration);
+        m3u8 += "seg_" + to_string(segment->seq) + ".ts\n";
+    }
+    if (pending) {
+        append_parts(pending);
+    }
+    _playlist = std::make_shared<const string>(std::move(m3u8));
+}
+
+bool HlsMediaSource::isReady_l(int64_t msn, int part) const {
+    if (!_playlist) {
+        return false;
+    }
+    if (msn < 0) {
+        return true;
+    }
+    for (auto &segment : _segments) {
+        if ((int64_t) segment->seq != msn) {
+            continue;
+        }
+        return segment->complete || (part >= 0 && (int) segment->parts.size() > part);
+    }
+    //切片已经移除或者尚未生成
+    return msn < (int64_t) _next_seq;
+}
+
+bool HlsMediaSource::getPlaylist(int64_t msn, int part, const PlaylistCB &cb) {
+    std::shared_ptr<const string> playlist;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        if (msn > (int64_t) _next_seq + 2) {
+            //ll-hls规定请求超前2个以上切片时返回400
+            return false;
+        }
+        if (!isReady_l(msn, part)) {
+            //阻塞式刷新，切片生成后再回复
+            _waiters.emplace_back(Waiter{msn, part, cb, getCurrentMillisecond()});
+            return true;
+        }
+        playlist = _playlist;
+    }
+    cb(playlist);
+    return true;
+}
+
+void HlsMediaSource::onPlaylistChanged() {
+    std::vector<Waiter> ready;
+    std::shared_ptr<const string> playlist;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        if (_waiters.empty()) {
+            return;
+        }
+        for (auto it = _waiters.begin(); it != _waiters.end();) {
+            if (isReady_l(it->msn, it->part)) {
+                ready.emplace_back(std::move(*it));
+                it = _waiters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        playlist = _playlist;
+    }
+    for (auto &waiter : ready) {
+        waiter.cb(playlist);
+    }
+}
+
+bool HlsMediaSource::getSegment(uint64_t seq, int part, List<Buffer::Ptr> &out) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    for (auto &segment : _segments) {
+        if (segment->seq != seq) {
+            continue;
+        }
+        if (part < 0) {
+            if (!segment->complete) {
+                return false;
+            }
+            for (auto &item : segment->parts) {
+                out.emplace_back(item.data);
+            }
+            return true;
+        }
+        if ((int) segment->parts.size() <= part) {
+            return false;
+        }
+        out.emplace_back(segment->parts[part].data);
+        return true;
+    }
+    return false;
+}
+
+int HlsMediaSource::readerCount() {
+    lock_guard<recursive_mutex> lck(_mtx);
+    return _readers.size();
+}
+
+void HlsMediaSource::onPlayerRequest(const string &client_id) {
+    int size;
+    bool added;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        auto it = _readers.find(client_id);
+        added = it == _readers.end();
+        if (added) {
+            _readers[client_id];
+        } else {
+            it->second.resetTime();
+        }
+        size = _readers.size();
+        if (!_reader_timer) {
+            //hls是短连接，定时清理不再请求的播放器
+            weak_ptr<HlsMediaSource> weak_self = dynamic_pointer_cast<HlsMediaSource>(shared_from_this());
+            _reader_timer = std::make_shared<Timer>(1.0f, [weak_self]() {
+                auto strong_self = weak_self.lock();
+                if (!strong_self) {
+                    return false;
+                }
+                strong_self->checkReaders();
+                strong_self->checkWaiters();
+                return true;
+            }, nullptr);
+        }
+    }
+    if (added) {
+        onReaderChanged(size);
+    }
+}
+
+void HlsMediaSource::checkWaiters() {
+    GET_CONFIG(uint32_t, segment_duration, Hls::kSegmentDuration);
+    std::vector<Waiter> expired;
+    auto now = getCurrentMillisecond();
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        //ll-hls规定阻塞式刷新最多等待3倍切片目标时长
+        uint64_t timeout_ms = 3 * 1000 * (uint64_t) (_target_duration ? _target_duration : MAX(segment_duration, 1u));
+        for (auto it = _waiters.begin(); it != _waiters.end();) {
+            if (now - it->start_ms > timeout_ms) {
+                expired.emplace_back(std::move(*it));
+                it = _waiters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto &waiter : expired) {
+        waiter.cb(nullptr);
+    }
+}
+
+bool HlsMediaSource::checkReaders() {
+    GET_CONFIG(uint32_t, segment_duration, Hls::kSegmentDuration);
+    GET_CONFIG(uint32_t, segment_num, Hls::kSegmentNum);
+    //播放器至少每个切片时长刷新一次m3u8
+    uint64_t timeout_ms = MAX(segment_duration * segment_num * 2, 10u) * 1000;
+    int size;
+    bool changed = false;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        for (auto it = _readers.begin(); it != _readers.end();) {
+            if (it->second.elapsedTime() > timeout_ms) {
+                it = _readers.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+        size = _readers.size();
+    }
+    if (changed) {
+        onReaderChanged(size);
+    }
+    return changed;
+}
+
+}//namespace mediakit
@@ -0,0 +1,136 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_HLSMEDIASOURCE_H
+#define ZLMEDIAKIT_HLSMEDIASOURCE_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "Common/MediaSource.h"
+#include "Poller/Timer.h"
+
+namespace mediakit {
+
+//ll-hls的部分切片，非ll-hls模式下一个切片只有一个部分切片
+class HlsPart {
+public:
+    Buffer::Ptr data;
+    float duration = 0;
+    //是否以关键帧开头
+    bool independent = false;
+};
+
+//ts切片，切片数据生成后不再拷贝，由所有hls播放器共享
+class HlsSegment {
+public:
+    using Ptr = std::shared_ptr<HlsSegment>;
+    uint64_t seq = 0;
+    float duration = 0;
+    bool complete = false;
+    std::vector<HlsPart> parts;
+};
+
+/**
+ * hls直播源，在内存中保存最近若干个ts切片并生成m3u8
+ * 切片在生成后不再拷贝，hls播放器只是发送共享的切片数据
+ */
+class HlsMediaSource : public MediaSource {
+public:
+    using Ptr = std::shared_ptr<HlsMediaSource>;
+    using PlaylistCB = function<void(const std::shared_ptr<const string> &playlist)>;
+
+    HlsMediaSource(const string &vhost, const string &app, const string &stream_id);
+    ~HlsMediaSource() override;
+
+    /**
+     * 获取播放器个数，一段时间内有请求的客户端视为播放器
+     */
+    int readerCount() override;
+
+    /**
+     * 设置切片参数
+     * @param part_duration ll-hls部分切片时长，单位秒，为0时关闭ll-hls
+     */
+    void setPartDuration(float part_duration);
+
+    /**
+     * 输入一个部分切片，非ll-hls模式下为整个切片
+     */
+    void inputPart(Buffer::Ptr data, float duration, bool independent);
+
+    /**
+     * 当前切片结束
+     */
+    void endSegment();
+
+    /**
+     * 清空切片，无人观看时调用，阻塞中的m3u8请求以空回复结束
+     */
+    void clearCache();
+
+    /**
+     * 获取m3u8，支持ll-hls阻塞式刷新
+     * @param msn _HLS_msn参数，小于0时不阻塞
+     * @param part _HLS_part参数，小于0时等待整个切片
+     * @param cb 回调，可能在其他线程触发；阻塞超过3倍切片目标时长、清空切片或者直播源销毁时回调空指针
+     * @return 参数是否合法
+     */
+    bool getPlaylist(int64_t msn, int part, const PlaylistCB &cb);
+
+    /**
+     * 获取切片数据
+     * @param seq 切片序号
+     * @param part 部分切片序号，小于0时获取整个切片
+     * @param out 切片数据
+     * @return 是否找到
+     */
+    bool getSegment(uint64_t seq, int part, List<Buffer::Ptr> &out);
+
+    /**
+     * hls客户端请求时调用，用于统计播放器个数
+     * @param client_id 播放器会话标识，不能使用ip(同一NAT后的多个播放器会被合并)
+     */
+    void onPlayerRequest(const string &client_id);
+
+private:
+    struct Waiter {
+        int64_t msn;
+        int part;
+        PlaylistCB cb;
+        //开始阻塞的时间
+        uint64_t start_ms;
+    };
+
+    bool isReady_l(int64_t msn, int part) const;
+    void makePlaylist_l();
+    void onPlaylistChanged();
+    bool checkReaders();
+    void checkWaiters();
+    //以空回复结束所有阻塞中的m3u8请求
+    void releaseWaiters();
+
+private:
+    bool _registed = false;
+    float _part_duration = 0;
+    //m3u8中的EXT-X-TARGETDURATION，单位秒
+    int _target_duration = 0;
+    uint64_t _next_seq = 0;
+    mutable recursive_mutex _mtx;
+    std::deque<HlsSegment::Ptr> _segments;
+    std::shared_ptr<const string> _playlist;
+    std::vector<Waiter> _waiters;
+    //播放器最后一次请求的时间
+    unordered_map<string, Ticker> _readers;
+    Timer::Ptr _reader_timer;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_HLSMEDIASOURCE_H
@@ -0,0 +1,142 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_HLSMEDIASOURCEMUXER_H
+#define ZLMEDIAKIT_HLSMEDIASOURCEMUXER_H
+
+#include "Http/HlsMediaSource.h"
+#include "Common/config.h"
+
+namespace mediakit {
+
+/**
+ * hls切片器，不单独复用ts，输入TSMediaSourceMuxer复用后的ts数据，与http-ts共享同一份ts复用
+ */
+class HlsMediaSourceMuxer : public MediaSourceEventInterceptor,
+                            public std::enable_shared_from_this<HlsMediaSourceMuxer> {
+public:
+    using Ptr = std::shared_ptr<HlsMediaSourceMuxer>;
+
+    HlsMediaSourceMuxer(const string &vhost,
+                        const string &app,
+                        const string &stream_id) {
+        GET_CONFIG(float, part_duration, Hls::kPartDuration);
+        _media_src = std::make_shared<HlsMediaSource>(vhost, app, stream_id);
+        _media_src->setPartDuration(part_duration);
+    }
+
+    ~HlsMediaSourceMuxer() = default;
+
+    void setListener(const std::weak_ptr<MediaSourceEvent> &listener){
+        setDelegate(listener);
+        _media_src->setListener(shared_from_this());
+    }
+
+    int readerCount() const{
+        return _media_src->readerCount();
+    }
+
+    void onReaderChanged(MediaSource &sender, int size) override {
+        GET_CONFIG(bool, hls_demand, General::kHlsDemand);
+        _enabled = hls_demand ? size : true;
+        if (!size && hls_demand) {
+            _clear_cache = true;
+        }
+        MediaSourceEventInterceptor::onReaderChanged(sender, size);
+    }
+
+    /**
+     * 输入一帧的ts数据
+     * @param buffer 由若干个188字节的ts包组成
+     * @param stamp 帧时间戳，单位毫秒
+     * @param key_frame 是否以PAT/PMT开头并可独立解码
+     */
+    void inputTs(const Buffer::Ptr &buffer, uint32_t stamp, bool key_frame) {
+        GET_CONFIG(bool, hls_demand, General::kHlsDemand);
+        if (_clear_cache && hls_demand) {
+            _clear_cache = false;
+            _media_src->clearCache();
+            resetSegment();
+        }
+        if (_enabled || !hls_demand) {
+            onTs(buffer, stamp, key_frame);
+        }
+    }
+
+    /**
+     * ts复用器重置track后调用，丢弃未完成的切片
+     */
+    void resetTracks() {
+        resetSegment();
+    }
+
+    bool isEnabled() {
+        GET_CONFIG(bool, hls_demand, General::kHlsDemand);
+        //缓存尚未清空时，还允许触发inputFrame函数，以便及时清空缓存
+        return hls_demand ? (_clear_cache ? true : _enabled) : true;
+    }
+
+private:
+    void onTs(const Buffer::Ptr &buffer, uint32_t stamp, bool key_frame) {
+        GET_CONFIG(uint32_t, segment_duration, Hls::kSegmentDuration);
+        GET_CONFIG(float, part_duration, Hls::kPartDuration);
+        if (!_segment_started) {
+            if (!key_frame) {
+                //切片必须以关键帧开头
+                return;
+            }
+            _segment_started = true;
+            _segment_stamp = _part_stamp = stamp;
+        } else if (key_frame && stamp - _segment_stamp >= segment_duration * 1000) {
+            //切片时长已到，在关键帧处切片
+            flushPart(stamp);
+            _media_src->endSegment();
+            _segment_stamp = stamp;
+        } else if (part_duration > 0 && stamp - _part_stamp >= part_duration * 1000) {
+            //ll-hls部分切片
+            flushPart(stamp);
+        }
+
+        if (_part_data.empty()) {
+            _part_independent = key_frame;
+        }
+        _part_data.append(buffer->data(), buffer->size());
+    }
+
+    void flushPart(uint32_t stamp) {
+        if (_part_data.empty()) {
+            return;
+        }
+        float duration = (stamp - _part_stamp) / 1000.0f;
+        _part_stamp = stamp;
+        //部分切片生成后不再拷贝，由所有播放器共享
+        _media_src->inputPart(std::make_shared<BufferString>(std::move(_part_data)), duration, _part_independent);
+        _part_data = string();
+    }
+
+    void resetSegment() {
+        _segment_started = false;
+        _part_data.clear();
+    }
+
+private:
+    bool _enabled = true;
+    bool _clear_cache = false;
+    bool _segment_started = false;
+    bool _part_independent = false;
+    uint32_t _segment_stamp = 0;
+    uint32_t _part_stamp = 0;
+    string _part_data;
+    HlsMediaSource::Ptr _media_src;
+};
+
+}//namespace mediakit
+
+#endif //ZLMEDIAKIT_HLSMEDIASOURCEMUXER_H
@@ -11,11 +11,35 @@ uint64_t HttpStringBody::remainSize() {
 }
 
 Buffer::Ptr HttpStringBody::readData(uint32_t size) {
-    size = _str.size();
-    if(size <= 0){
+    if(_str.empty()){
         return nullptr;
     }
-    return std::make_shared<BufferString>(_str, 0, size);
+    //一次性读取全部数据，读取后body为空，否则会被重复发送
+    auto ret = std::make_shared<BufferString>(std::move(_str));
+    _str.clear();
+    return ret;
+}
+
+HttpBufferBody::HttpBufferBody(List<Buffer::Ptr> buffers){
+    _buffers.swap(buffers);
+    _buffers.for_each([&](const Buffer::Ptr &buffer){
+        _size += buffer->size();
+    });
+}
+
+uint64_t HttpBufferBody::remainSize() {
+    return _size;
+}
+
+Buffer::Ptr HttpBufferBody::readData(uint32_t size) {
+    if(_buffers.empty()){
+        return nullptr;
+    }
+    //直接返回共享缓存，不拷贝
+    auto ret = std::move(_buffers.front());
+    _buffers.pop_front();
+    _size -= ret->size();
+    return ret;
 }
 
 }//namespace mediakit
@@ -17,6 +17,7 @@
 #include "Network/Buffer.h"
 #include "Common/Parser.h"
 #include "Util/mini.h"
+#include "Util/List.h"
 #include "strCoding.h"
 
 using namespace std;
@@ -70,6 +71,21 @@ private:
     mutable std::string _str;
 };
 
+/**
+ * 由共享缓存组成的body，发送时不拷贝数据
+ */
+class HttpBufferBody : public HttpBody{
+public:
+    typedef std::shared_ptr<HttpBufferBody> Ptr;
+    HttpBufferBody(List<Buffer::Ptr> buffers);
+    virtual ~HttpBufferBody(){}
+    uint64_t remainSize() override ;
+    Buffer::Ptr readData(uint32_t size) override ;
+private:
+    uint64_t _size = 0;
+    List<Buffer::Ptr> _buffers;
+};
+
 }//namespace mediakit
 
 #endif //ZLMEDIAKIT_FILEREADER_H
@@ -88,7 +88,8 @@ void HttpSession::onError(const SockException& err) {
                     << _mediaInfo._app << "/"
                     << _mediaInfo._streamid << ","
                     << duration << "s,"
-                    << _total_bytes_usage / 1024.0 / 1024.0 << "MB";
+                    << _total_bytes_usage / 1024.0 / 1024.0 << "MB,"
+                    << "drop:" << _slow_viewer.getDropCount();
         return;
     }
 
@@ -214,28 +215,281 @@ bool HttpSession::checkLiveStreamFMP4(const function<void()> &cb){
             onWrite(std::make_shared<BufferString>(first_message), true);
         }
 
-        onWrite(std::make_shared<BufferString>(fmp4_src->getInitSegment()), true);
+        //带start_time参数时从内存录像窗口中时移播放，init segment需要与录像分片匹配
+        _time_shift = createTimeShiftReader();
+        onWrite(std::make_shared<BufferString>(_time_shift ? *_time_shift->getInitSegment() : fmp4_src->getInitSegment()), true);
         weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
-        _fmp4_reader = fmp4_src->getRing()->attach(getPoller());
-        _fmp4_reader->setDetachCB([weak_self]() {
+        MediaSource::colocateReader(shared_from_this(), fmp4_src->getRing()->getReaderPoller(), [weak_self, fmp4_src]() {
             auto strong_self = weak_self.lock();
-            if (!strong_self) {
-                return;
+            if (strong_self) {
+                strong_self->attachFMP4Reader(fmp4_src);
+            }
+        });
+    });
+}
+
+void HttpSession::attachFMP4Reader(const FMP4MediaSource::Ptr &fmp4_src) {
+    GET_CONFIG(uint32_t, zero_copy_min_size, General::kZeroCopyMinSize);
+    //播放器发送的都是所有播放器共享的直播数据，适合零拷贝
+    enableZeroCopy(zero_copy_min_size);
+    weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
+    _fmp4_reader = fmp4_src->getRing()->attach(getPoller());
+    _fmp4_reader->setDetachCB([weak_self]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        strong_self->shutdown(SockException(Err_shutdown, "fmp4 ring buffer detached"));
+    });
+    if (_time_shift) {
+        _time_shift->start(getPoller(), [weak_self](const FMP4Packet::Ptr &packet, bool flush) {
+            auto strong_self = weak_self.lock();
+            if (strong_self) {
+                strong_self->sendFMP4Packet(packet, flush);
+            }
+        }, [weak_self](const string &reason) {
+            auto strong_self = weak_self.lock();
+            if (strong_self) {
+                strong_self->shutdown(SockException(Err_shutdown, "fmp4 time shift detached:" + reason));
+            }
+        }, [weak_self]() {
+            //发送拥塞时暂停读取录像窗口，恢复后从原处继续
+            auto strong_self = weak_self.lock();
+            return !strong_self || strong_self->_slow_viewer.pauseSending(*strong_self);
+        });
+    }
+    _fmp4_reader->setReadKeyCB([weak_self](const FMP4MediaSource::RingDataType &fmp4_list, bool is_key) {
+        auto strong_self = weak_self.lock();
+        //时移播放时直播环形缓冲只用于播放器计数以及注销通知，不发送直播数据
+        if (!strong_self || strong_self->_time_shift ||
+            strong_self->_slow_viewer.dropPacket(*strong_self, is_key, fmp4_list->size())) {
+            return;
+        }
+        int i = 0;
+        int size = fmp4_list->size();
+        fmp4_list->for_each([&](const FMP4Packet::Ptr &fmp4) {
+            strong_self->sendFMP4Packet(fmp4, ++i == size);
+        });
+    });
+}
+
+TimeShiftReader::Ptr HttpSession::createTimeShiftReader() {
+    auto &args = _parser.getUrlArgs();
+    auto it = args.find("start_time");
+    if (it == args.end() || it->second.empty()) {
+        return nullptr;
+    }
+    //start_time为unix时间戳(秒)，小于等于0时为相对当前时间的秒数
+    auto start_time = atof(it->second.data());
+    auto start_utc_ms = (uint64_t) (start_time > 0 ? start_time * 1000 : getCurrentMillisecond(true) + start_time * 1000);
+    //speed为追赶直播的倍速
+    it = args.find("speed");
+    auto speed = it == args.end() ? 1.0f : (float) atof(it->second.data());
+
+    auto stream = RecordPool::Instance().findStream(_mediaInfo._vhost, _mediaInfo._app, _mediaInfo._streamid);
+    auto reader = TimeShiftReader::create(stream, start_utc_ms, speed);
+    if (!reader) {
+        WarnP(this) << "内存录像窗口中没有数据，改为直播:" << _mediaInfo._app << "/" << _mediaInfo._streamid;
+        return nullptr;
+    }
+    InfoP(this) << "fmp4时移播放:" << _mediaInfo._app << "/" << _mediaInfo._streamid
+                << ", 请求时间:" << start_utc_ms << ", 开始时间:" << reader->getStartUtc() << ", 倍速:" << speed;
+    return reader;
+}
+
+void HttpSession::sendFMP4Packet(const FMP4Packet::Ptr &packet, bool flush) {
+    _ticker.resetTime();
+    //websocket时第一个片段带有预编码的帧头，其余帧数据直接发送
+    packet->for_each(_live_over_websocket, [&](const Buffer::Ptr &buf, bool last) {
+        if (flush && last) {
+            //需要flush那么一次刷新缓存
+            HttpSession::setSendFlushFlag(true);
+        }
+        send(buf);
+    });
+    if (flush) {
+        //本次刷新缓存后，下次不用刷新缓存
+        HttpSession::setSendFlushFlag(false);
+    }
+    _total_bytes_usage += packet->size();
+}
+
+bool HttpSession::checkLiveStreamTS(const function<void()> &cb){
+    return checkLiveStream(TS_SCHEMA, ".ts", [this, cb](const MediaSource::Ptr &src) {
+        auto ts_src = dynamic_pointer_cast<TSMediaSource>(src);
+        assert(ts_src);
+        if (!cb) {
+            //找到源，发送http头，负载后续发送
+            sendResponse("200 OK", false, "video/mp2t", KeyValue(), nullptr, true);
+        } else {
+            //自定义发送http头
+            cb();
+        }
+
+        weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
+        MediaSource::colocateReader(shared_from_this(), ts_src->getRing()->getReaderPoller(), [weak_self, ts_src]() {
+            auto strong_self = weak_self.lock();
+            if (strong_self) {
+                strong_self->attachTSReader(ts_src);
             }
-            strong_self->shutdown(SockException(Err_shutdown, "fmp4 ring buffer detached"));
         });
-        _fmp4_reader->setReadCB([weak_self](const FMP4MediaSource::RingDataType &fmp4_list) {
+    });
+}
+
+void HttpSession::attachTSReader(const TSMediaSource::Ptr &ts_src) {
+    GET_CONFIG(uint32_t, zero_copy_min_size, General::kZeroCopyMinSize);
+    //播放器发送的都是所有播放器共享的直播数据，适合零拷贝
+    enableZeroCopy(zero_copy_min_size);
+    weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
+    _ts_reader = ts_src->getRing()->attach(getPoller());
+    _ts_reader->setDetachCB([weak_self]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        strong_self->shutdown(SockException(Err_shutdown, "ts ring buffer detached"));
+    });
+    _ts_reader->setReadKeyCB([weak_self](const TSMediaSource::RingDataType &ts_list, bool is_key) {
+        auto strong_self = weak_self.lock();
+        if (!strong_self || strong_self->_slow_viewer.dropPacket(*strong_self, is_key, ts_list->size())) {
+            return;
+        }
+        //合并写的一批ts包最后才刷新，一次sendmsg发送
+        int i = 0;
+        int size = ts_list->size();
+        ts_list->for_each([&](const TSPacket::Ptr &ts) {
+            strong_self->onWrite(ts, ++i == size);
+        });
+    });
+}
+
+//hls播放器会话标识的cookie名
+static const string kHlsCookie = "zlm_hls_session";
+
+static string findCookie(const string &cookies, const string &key) {
+    for (auto &item : split(cookies, ";")) {
+        trim(item);
+        if (item.size() > key.size() && start_with(item, key) && item[key.size()] == '=') {
+            return item.substr(key.size() + 1);
+        }
+    }
+    return "";
+}
+
+bool HttpSession::checkLiveStreamHls() {
+    //m3u8为/app/stream/hls.m3u8，切片为/app/stream/seg_序号.ts，ll-hls部分切片为/app/stream/seg_序号_部分序号.ts
+    auto &url = _parser.Url();
+    auto pos = url.rfind('/');
+    if (pos == string::npos || pos == 0) {
+        return false;
+    }
+    auto file_name = url.substr(pos + 1);
+    bool is_playlist = file_name == "hls.m3u8";
+    uint64_t seq = 0;
+    int part = -1;
+    if (!is_playlist) {
+        if (file_name.size() <= 7 || !start_with(file_name, "seg_") || !end_with(file_name, ".ts")) {
+            return false;
+        }
+        auto name = file_name.substr(4, file_name.size() - 7);
+        if (name.find_first_not_of("0123456789_") != string::npos) {
+            return false;
+        }
+        seq = strtoull(name.data(), nullptr, 10);
+        auto sep = name.find('_');
+        if (sep != string::npos) {
+            part = atoi(name.data() + sep + 1);
+        }
+    }
+
+    auto full_url = string(HLS_SCHEMA) + "://" + _parser["Host"] + url.substr(0, pos);
+    if (!_parser.Params().empty()) {
+        full_url += "?" + _parser.Params();
+    }
+    _mediaInfo.parse(full_url);
+    if (_mediaInfo._app.empty() || _mediaInfo._streamid.empty()) {
+        return false;
+    }
+    bool close_flag = !strcasecmp(_parser["Connection"].data(), "close");
+    //按播放器会话统计hls播放器，同一NAT后的多个播放器ip相同；
+    //m3u8回复中下发会话cookie，不支持cookie的播放器以tcp连接区分
+    auto client_id = findCookie(_parser["Cookie"], kHlsCookie);
+    bool set_cookie = client_id.empty() && is_playlist;
+    if (set_cookie) {
+        client_id = makeRandStr(16);
+    } else if (client_id.empty()) {
+        client_id = get_peer_ip() + ":" + to_string(get_peer_port());
+    }
+
+    if (!is_playlist) {
+        //切片只会在获取m3u8之后请求，直接同步查找
+        auto hls_src = dynamic_pointer_cast<HlsMediaSource>(MediaSource::find(HLS_SCHEMA, _mediaInfo._vhost, _mediaInfo._app, _mediaInfo._streamid));
+        List<Buffer::Ptr> buffers;
+        if (!hls_src || !hls_src->getSegment(seq, part, buffers)) {
+            sendNotFound(close_flag);
+            return true;
+        }
+        hls_src->onPlayerRequest(client_id);
+        //切片数据由所有播放器共享，发送时不拷贝
+        sendResponse("200 OK", close_flag, "video/mp2t", KeyValue(), std::make_shared<HttpBufferBody>(std::move(buffers)));
+        return true;
+    }
+
+    //ll-hls阻塞式刷新参数
+    int64_t msn = -1;
+    int hls_part = -1;
+    auto &args = _parser.getUrlArgs();
+    auto it = args.find("_HLS_msn");
+    if (it != args.end()) {
+        msn = atoll(it->second.data());
+        it = args.find("_HLS_part");
+        if (it != args.end()) {
+            hls_part = atoi(it->second.data());
+        }
+    }
+
+    std::weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
+    MediaSource::findAsync(_mediaInfo, weak_self.lock(), [weak_self, close_flag, client_id, set_cookie, msn, hls_part](const MediaSource::Ptr &src) {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        auto hls_src = dynamic_pointer_cast<HlsMediaSource>(src);
+        if (!hls_src) {
+            strong_self->sendNotFound(close_flag);
+            return;
+        }
+        hls_src->onPlayerRequest(client_id);
+        auto valid = hls_src->getPlaylist(msn, hls_part, [weak_self, close_flag, client_id, set_cookie](const std::shared_ptr<const string> &playlist) {
             auto strong_self = weak_self.lock();
             if (!strong_self) {
                 return;
             }
-            int i = 0;
-            int size = fmp4_list->size();
-            fmp4_list->for_each([&](const FMP4Packet::Ptr &ts) {
-                strong_self->onWrite(ts, ++i == size);
+            //阻塞式刷新时在切片线程回调，切换到本session线程
+            strong_self->async([weak_self, close_flag, client_id, set_cookie, playlist]() {
+                auto strong_self = weak_self.lock();
+                if (!strong_self) {
+                    return;
+                }
+                if (!playlist) {
+                    //阻塞超时或者切片已清空
+                    strong_self->sendResponse("503 Service Unavailable", close_flag);
+                    return;
+                }
+                KeyValue header;
+                header["Cache-Control"] = "no-cache";
+                if (set_cookie) {
+                    header["Set-Cookie"] = kHlsCookie + "=" + client_id + "; Path=/";
+                }
+                strong_self->sendResponse("200 OK", close_flag, "application/vnd.apple.mpegurl", header,
+                                          std::make_shared<HttpStringBody>(*playlist));
             });
         });
+        if (!valid) {
+            strong_self->sendResponse("400 Bad Request", close_flag);
+        }
     });
+    return true;
 }
 
 bool HttpSession::checkLiveStreamFlv(const function<void()> &cb){
@@ -255,7 +509,17 @@ bool HttpSession::checkLiveStreamFlv(const function<void()> &cb){
             cb();
         }
 
-        start(getPoller(), rtmp_src);
+        weak_ptr<HttpSession> weak_self = dynamic_pointer_cast<HttpSession>(shared_from_this());
+        MediaSource::colocateReader(shared_from_this(), rtmp_src->getFlvRing()->getReaderPoller(), [weak_self, rtmp_src]() {
+            auto strong_self = weak_self.lock();
+            if (!strong_self) {
+                return;
+            }
+            GET_CONFIG(uint32_t, zero_copy_min_size, General::kZeroCopyMinSize);
+            //播放器发送的都是所有播放器共享的直播数据，适合零拷贝
+            strong_self->enableZeroCopy(zero_copy_min_size);
+            strong_self->start(strong_self->getPoller(), rtmp_src);
+        });
     });
 }
 
@@ -271,6 +535,10 @@ void HttpSession::Handle_Req_GET(int64_t &content_len) {
         return;
     }
 
+    if (checkLiveStreamHls()) {
+        return;
+    }
+
     if (checkLiveStreamFMP4()) {
         InfoL << "pull http-mp4 stream:" << _mediaInfo._streamid;
         return;
@@ -281,6 +549,11 @@ void HttpSession::Handle_Req_GET(int64_t &content_len) {
         return;
     }
 
+    if (checkLiveStreamTS()) {
+        InfoL << "pull http-ts stream:" << _mediaInfo._streamid;
+        return;
+    }
+
     auto [code, header, body] = HookServer::Instance().http_request(_parser);
     sendResponse(code.data(), true, nullptr, header, std::make_shared<HttpStringBody>(body));
 }
@@ -545,4 +818,8 @@ std::shared_ptr<FlvMuxer> HttpSession::getSharedPtr(){
     return dynamic_pointer_cast<FlvMuxer>(shared_from_this());
 }
 
+bool HttpSession::dropPacket(bool is_key) {
+    return _slow_viewer.dropPacket(*this, is_key);
+}
+
 } /* namespace mediakit */
@@ -19,7 +19,11 @@
 #include "HttpRequestSplitter.h"
 #include "WebSocketSplitter.h"
 #include "Http/FMP4MediaSource.h"
+#include "Http/HlsMediaSource.h"
+#include "Http/TSMediaSource.h"
 #include "Http/HttpBody.h"
+#include "Common/SlowViewerPolicy.h"
+#include "Record/TimeShiftReader.h"
 
 using namespace std;
 using namespace toolkit;
@@ -55,6 +59,7 @@ protected:
     void onWrite(const Buffer::Ptr &data, bool flush) override ;
     void onDetach() override;
     std::shared_ptr<FlvMuxer> getSharedPtr() override;
+    bool dropPacket(bool is_key) override;
 
     //HttpRequestSplitter override
     int64_t onRecvHeader(const char *data,uint64_t len) override;
@@ -109,6 +114,12 @@ private:
 
     bool checkLiveStreamFlv(const std::function<void()> &cb = nullptr);
     bool checkLiveStreamFMP4(const std::function<void()> &fmp4_list = nullptr);
+    bool checkLiveStreamHls();
+    bool checkLiveStreamTS(const std::function<void()> &cb = nullptr);
+    void attachFMP4Reader(const FMP4MediaSource::Ptr &fmp4_src);
+    TimeShiftReader::Ptr createTimeShiftReader();
+    void sendFMP4Packet(const FMP4Packet::Ptr &packet, bool flush);
+    void attachTSReader(const TSMediaSource::Ptr &ts_src);
 
     bool checkWebSocket();
     void urlDecode(Parser &parser);
@@ -129,6 +140,11 @@ private:
     Ticker _ticker;
     MediaInfo _mediaInfo;
     FMP4MediaSource::RingType::RingReader::Ptr _fmp4_reader;
+    //fmp4时移播放游标
+    TimeShiftReader::Ptr _time_shift;
+    TSMediaSource::RingType::RingReader::Ptr _ts_reader;
+    //慢速播放器丢帧策略
+    SlowViewerPolicy _slow_viewer;
     std::function<bool (const char *data, uint64_t len) > _contentCallBack;
     bool is_fmp4_websocket_ = false;
     bool websocket_first_send_ = true;
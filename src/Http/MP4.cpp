@@ -77,6 +77,14 @@ int mp4_writer_write_l(mp4_writer_t* mp4, int track, const void* data, size_t by
     }
 }
 
+int mp4_writer_write_ref(mp4_writer_t* mp4, int track, size_t bytes, int64_t pts, int64_t dts, int flags){
+    if (mp4->is_fmp4) {
+        return fmp4_writer_write_ref(mp4->u.fmp4, track, bytes, pts, dts, flags);
+    } else {
+        return -1;
+    }
+}
+
 int mp4_writer_save_segment(mp4_writer_t* mp4){
     if (mp4->is_fmp4) {
         return fmp4_writer_save_segment(mp4->u.fmp4);
@@ -133,13 +141,48 @@ MP4FileIO::Writer MP4FileIO::createWriter(int flags, bool is_fmp4){
 
 string MP4FileMemory::getAndClearMemory(){
     string ret;
-    ret.swap(_memory);
+    _chain.for_each([&](const Buffer::Ptr &buf) {
+        ret.append(buf->data(), buf->size());
+    });
+    if (ret.empty()) {
+        ret.swap(_memory);
+    } else {
+        ret.append(_memory);
+    }
+    _memory.clear();
+    _chain.clear();
+    _sample_refs.clear();
+    _chain_size = 0;
     _offset = 0;
     return ret;
 }
 
+List<Buffer::Ptr> MP4FileMemory::getAndClearBuffers(){
+    flushMemory();
+    List<Buffer::Ptr> ret;
+    ret.swap(_chain);
+    //未被复用器使用的引用丢弃
+    _sample_refs.clear();
+    _chain_size = 0;
+    _offset = 0;
+    return ret;
+}
+
+void MP4FileMemory::addSampleRef(Buffer::Ptr buf){
+    _sample_refs.emplace_back(std::move(buf));
+}
+
+void MP4FileMemory::flushMemory(){
+    if (_memory.empty()) {
+        return;
+    }
+    _chain_size += _memory.size();
+    _chain.emplace_back(std::make_shared<BufferString>(std::move(_memory)));
+    _memory.clear();
+}
+
 uint64_t MP4FileMemory::fileSize() const{
-    return _memory.size();
+    return _chain_size + _memory.size();
 }
 
 uint64_t MP4FileMemory::onTell(){
@@ -147,7 +190,7 @@ uint64_t MP4FileMemory::onTell(){
 }
 
 int MP4FileMemory::onSeek(uint64_t offset){
-    if (offset > _memory.size()) {
+    if (offset < _chain_size || offset > fileSize()) {
         return -1;
     }
     _offset = offset;
@@ -155,24 +198,54 @@ int MP4FileMemory::onSeek(uint64_t offset){
 }
 
 int MP4FileMemory::onRead(void *data, uint64_t bytes){
-    if (_offset >= _memory.size()) {
+    if (_offset < _chain_size || _offset >= fileSize()) {
         //EOF
         return -1;
     }
-    bytes = MIN(bytes, _memory.size() - _offset);
-    memcpy(data, _memory.data(), bytes);
+    auto pos = _offset - _chain_size;
+    bytes = MIN(bytes, _memory.size() - pos);
+    memcpy(data, _memory.data() + pos, bytes);
     _offset += bytes;
     return 0;
 }
 
 int MP4FileMemory::onWrite(const void *data, uint64_t bytes){
-    if (_offset + bytes > _memory.size()) {
+    if (!data) {
+        return onWriteRef(bytes);
+    }
+    if (_offset < _chain_size) {
+        return -1;
+    }
+    auto pos = _offset - _chain_size;
+    if (pos + bytes > _memory.size()) {
         //需要扩容
-        _memory.resize(_offset + bytes);
+        _memory.resize(pos + bytes);
     }
-    memcpy((uint8_t *) _memory.data() + _offset, data, bytes);
+    memcpy((uint8_t *) _memory.data() + pos, data, bytes);
     _offset += bytes;
     return 0;
 }
 
+int MP4FileMemory::onWriteRef(uint64_t bytes){
+    if (_offset != fileSize()) {
+        //sample引用只能追加在末尾
+        return -1;
+    }
+    //此前写入的box头等数据不再修改
+    flushMemory();
+    while (bytes) {
+        if (_sample_refs.empty() || _sample_refs.front()->size() > bytes) {
+            WarnL << "fmp4 sample引用数据与sample长度不匹配";
+            return -1;
+        }
+        auto size = _sample_refs.front()->size();
+        _chain.emplace_back(std::move(_sample_refs.front()));
+        _sample_refs.pop_front();
+        _chain_size += size;
+        _offset += size;
+        bytes -= size;
+    }
+    return 0;
+}
+
 }//namespace mediakit
@@ -19,6 +19,8 @@
 #include "mpeg4-avc.h"
 #include "mov-buffer.h"
 #include "mov-format.h"
+#include "Util/List.h"
+#include "Network/Buffer.h"
 
 namespace mediakit {
 
@@ -31,6 +33,7 @@ int mp4_writer_add_video(mp4_writer_t* mp4, uint8_t object, int width, int heigh
 int mp4_writer_add_subtitle(mp4_writer_t* mp4, uint8_t object, const void* extra_data, size_t extra_data_size);
 int mp4_writer_write(mp4_writer_t* mp4, int track, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags);
 int mp4_writer_write_l(mp4_writer_t* mp4, int track, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags, int add_nalu_size);
+int mp4_writer_write_ref(mp4_writer_t* mp4, int track, size_t bytes, int64_t pts, int64_t dts, int flags);
 int mp4_writer_save_segment(mp4_writer_t* mp4);
 int mp4_writer_init_segment(mp4_writer_t* mp4);
 
@@ -46,7 +49,7 @@ public:
 
     /**
      * 创建mp4复用器
-     * @param flags 支持0、MOV_FLAG_FASTSTART、MOV_FLAG_SEGMENT
+     * @param flags 支持0、MOV_FLAG_FASTSTART、MOV_FLAG_SEGMENT、MOV_FLAG_CACHE(仅fmp4，适合内存文件)
      * @param is_fmp4 是否为fmp4还是普通mp4
      * @return mp4复用器
      */
@@ -91,15 +94,33 @@ public:
 
     std::string getAndClearMemory();
 
+    /**
+     * 获取并清空内存中的数据，sample数据为addSampleRef添加的引用，不拷贝
+     */
+    toolkit::List<toolkit::Buffer::Ptr> getAndClearBuffers();
+
+    /**
+     * 添加sample数据引用，复用器以零拷贝方式(mp4_writer_write_ref)写入sample时按顺序使用这些数据
+     */
+    void addSampleRef(toolkit::Buffer::Ptr buf);
+
 protected:
     uint64_t onTell() override;
     int onSeek(uint64_t offset) override;
     int onRead(void *data, uint64_t bytes) override;
     int onWrite(const void *data, uint64_t bytes) override;
 
+private:
+    int onWriteRef(uint64_t bytes);
+    void flushMemory();
+
 private:
     uint64_t _offset = 0;
+    //_chain中的数据长度，这部分数据不能再seek修改
+    uint64_t _chain_size = 0;
     std::string _memory;
+    toolkit::List<toolkit::Buffer::Ptr> _chain;
+    toolkit::List<toolkit::Buffer::Ptr> _sample_refs;
 };
 
 }//namespace mediakit
@@ -52,35 +52,7 @@ void MP4MuxerInterface::inputFrame(const Frame::Ptr &frame) {
                 Frame::Ptr back = _frameCached.back();
                 //求相对时间戳
                 track_info.stamp.revise(back->dts(), back->pts(), dts_out, pts_out);
-
-                if (_frameCached.size() != 1) {
-                    //缓存中有多帧，需要按照mp4格式合并一起
-                    BufferLikeString merged;
-                    merged.reserve(back->size() + 1024);
-                    _frameCached.for_each([&](const Frame::Ptr &frame) {
-                        uint32_t nalu_size = frame->size() - frame->prefixSize();
-                        nalu_size = htonl(nalu_size);
-                        merged.append((char *) &nalu_size, 4);
-                        merged.append(frame->data() + frame->prefixSize(), frame->size() - frame->prefixSize());
-                    });
-                    mp4_writer_write(_mov_writter.get(),
-                                       track_info.track_id,
-                                       merged.data(),
-                                       merged.size(),
-                                       pts_out,
-                                       dts_out,
-                                       back->keyFrame() ? MOV_AV_FLAG_KEYFREAME : 0);
-                } else {
-                    //缓存中只有一帧视频
-                    mp4_writer_write_l(_mov_writter.get(),
-                                       track_info.track_id,
-                                       back->data() + back->prefixSize(),
-                                       back->size() - back->prefixSize(),
-                                       pts_out,
-                                       dts_out,
-                                       back->keyFrame() ? MOV_AV_FLAG_KEYFREAME : 0,
-                                       1/*需要生成头4个字节的MP4格式start code*/);
-                }
+                writeSample(track_info.track_id, _frameCached, true, pts_out, dts_out, back->keyFrame());
                 _frameCached.clear();
             }
             //缓存帧，时间戳相同的帧合并一起写入mp4
@@ -89,18 +61,44 @@ void MP4MuxerInterface::inputFrame(const Frame::Ptr &frame) {
             break;
         default: {
             track_info.stamp.revise(frame->dts(), frame->pts(), dts_out, pts_out);
-            mp4_writer_write(_mov_writter.get(),
-                             track_info.track_id,
-                             frame->data() + frame->prefixSize(),
-                             frame->size() - frame->prefixSize(),
-                             pts_out,
-                             dts_out,
-                             frame->keyFrame() ? MOV_AV_FLAG_KEYFREAME : 0);
+            List<Frame::Ptr> frames;
+            frames.emplace_back(frame);
+            writeSample(track_info.track_id, frames, false, pts_out, dts_out, frame->keyFrame());
         }
             break;
     }
 }
 
+void MP4MuxerInterface::writeSample(int track_id, List<Frame::Ptr> &frames, bool add_nalu_size, int64_t pts, int64_t dts, bool key) {
+    auto flags = key ? MOV_AV_FLAG_KEYFREAME : 0;
+    if (frames.size() == 1) {
+        auto &frame = frames.front();
+        //add_nalu_size时由复用器生成头4个字节的MP4格式start code
+        mp4_writer_write_l(_mov_writter.get(),
+                           track_id,
+                           frame->data() + frame->prefixSize(),
+                           frame->size() - frame->prefixSize(),
+                           pts,
+                           dts,
+                           flags,
+                           add_nalu_size);
+        return;
+    }
+
+    //缓存中有多帧，需要按照mp4格式合并一起
+    BufferLikeString merged;
+    merged.reserve(frames.back()->size() + 1024);
+    frames.for_each([&](const Frame::Ptr &frame) {
+        if (add_nalu_size) {
+            uint32_t nalu_size = frame->size() - frame->prefixSize();
+            nalu_size = htonl(nalu_size);
+            merged.append((char *) &nalu_size, 4);
+        }
+        merged.append(frame->data() + frame->prefixSize(), frame->size() - frame->prefixSize());
+    });
+    mp4_writer_write(_mov_writter.get(), track_id, merged.data(), merged.size(), pts, dts, flags);
+}
+
 static uint8_t getObject(CodecId codecId){
     switch (codecId){
         case CodecG711A : return MOV_OBJECT_G711a;
@@ -217,8 +215,17 @@ MP4MuxerMemory::MP4MuxerMemory() {
     _memory_file = std::make_shared<MP4FileMemory>();
 }
 
+void MP4MuxerMemory::setFragmentMode(FragmentMode mode, uint32_t fragment_ms) {
+    _fragment_mode = mode;
+    _fragment_ms = fragment_ms;
+}
+
 MP4FileIO::Writer MP4MuxerMemory::createWriter() {
-    return _memory_file->createWriter(MOV_FLAG_SEGMENT, true);
+    auto flags = MOV_FLAG_SEGMENT | MOV_FLAG_CACHE;
+    if (_fragment_mode == FragmentCMAF) {
+        flags |= MOV_FLAG_CMAF;
+    }
+    return _memory_file->createWriter(flags, true);
 }
 
 const string &MP4MuxerMemory::getInitSegment(){
@@ -234,6 +241,7 @@ void MP4MuxerMemory::resetTracks(){
     MP4MuxerInterface::resetTracks();
     _memory_file = std::make_shared<MP4FileMemory>();
     _init_segment.clear();
+    _fragment_samples = 0;
 }
 
 void MP4MuxerMemory::inputFrame(const Frame::Ptr &frame){
@@ -241,10 +249,82 @@ void MP4MuxerMemory::inputFrame(const Frame::Ptr &frame){
         return;
     }
 
+    _stamp = frame->dts();
     MP4MuxerInterface::inputFrame(frame);
+    if (_fragment_mode == FragmentPerFrame || (_fragment_mode == FragmentCMAF && !_fragment_ms)) {
+        //每帧立即输出分片
+        flushFragment();
+    }
+}
+
+bool MP4MuxerMemory::needNewFragment(bool video_key, int64_t dts) const {
+    if (video_key) {
+        return true;
+    }
+    switch (_fragment_mode) {
+        case FragmentDuration:
+        case FragmentCMAF: return _fragment_ms && dts - _fragment_dts >= _fragment_ms;
+        //纯音频时没有关键帧，每秒一个分片
+        case FragmentGop: return !haveVideo() && dts - _fragment_dts >= 1000;
+        default: return false;
+    }
+}
+
+void MP4MuxerMemory::flushFragment() {
+    if (!_fragment_samples) {
+        return;
+    }
+    _fragment_samples = 0;
     saveSegment();
-    onSegmentData(_memory_file->getAndClearMemory(), frame->dts(), _key_frame);
-    _key_frame = frame->keyFrame();
+    auto segment = _memory_file->getAndClearBuffers();
+    if (!segment.empty()) {
+        onSegmentData(std::move(segment), _stamp, _fragment_key);
+    }
+}
+
+//引用帧负载(去除帧前缀)的缓存，不拷贝数据
+class FramePayload : public Buffer {
+public:
+    FramePayload(Frame::Ptr frame) : _frame(std::move(frame)) {}
+    ~FramePayload() override = default;
+
+    char *data() const override {
+        return _frame->data() + _frame->prefixSize();
+    }
+
+    uint32_t size() const override {
+        return _frame->size() - _frame->prefixSize();
+    }
+
+private:
+    Frame::Ptr _frame;
+};
+
+void MP4MuxerMemory::writeSample(int track_id, List<Frame::Ptr> &frames, bool add_nalu_size, int64_t pts, int64_t dts, bool key) {
+    //新分片的开始sample写入前，先输出之前的分片
+    bool video_key = key && frames.front()->getTrackType() == TrackVideo;
+    if (_fragment_samples && needNewFragment(video_key, dts)) {
+        flushFragment();
+    }
+    if (!_fragment_samples++) {
+        _fragment_key = video_key;
+        _fragment_dts = dts;
+    }
+
+    size_t bytes = 0;
+    frames.for_each([&](const Frame::Ptr &frame) {
+        uint32_t size = frame->size() - frame->prefixSize();
+        if (add_nalu_size) {
+            //MP4格式的4个字节nalu长度
+            uint32_t nalu_size = htonl(size);
+            _memory_file->addSampleRef(std::make_shared<BufferString>(string((char *) &nalu_size, 4)));
+            bytes += 4;
+        }
+        //切片会被播放器共享缓存，帧必须可缓存
+        _memory_file->addSampleRef(std::make_shared<FramePayload>(Frame::getCacheAbleFrame(frame)));
+        bytes += size;
+    });
+    mp4_writer_write_ref(_mov_writter.get(), track_id, bytes, pts, dts, key ? MOV_AV_FLAG_KEYFREAME : 0);
 }
 
 
@@ -58,12 +58,25 @@ public:
 
 protected:
     virtual MP4FileIO::Writer createWriter() = 0;
+
+    /**
+     * 写入一个sample，默认拷贝数据到复用器
+     * @param track_id mp4 track id
+     * @param frames 组成该sample的帧，时间戳相同
+     * @param add_nalu_size 是否需要把帧前缀替换为4个字节的nalu长度(h264/h265)
+     * @param pts 相对显示时间戳
+     * @param dts 相对解码时间戳
+     * @param key 是否为关键帧
+     */
+    virtual void writeSample(int track_id, List<Frame::Ptr> &frames, bool add_nalu_size, int64_t pts, int64_t dts, bool key);
+
+protected:
     std::string mse_mime_type_;
-    
+    MP4FileIO::Writer _mov_writter;
+
 private:
     bool _started = false;
     bool _have_video = false;
-    MP4FileIO::Writer _mov_writter;
     struct track_info {
         int track_id = -1;
         Stamp stamp;
@@ -74,9 +87,28 @@ private:
 
 class MP4MuxerMemory : public MP4MuxerInterface{
 public:
+    //fmp4分片策略，视频关键帧总是开始新的分片
+    enum FragmentMode {
+        //每帧一个分片(moof+mdat)，延时最低
+        FragmentPerFrame = 0,
+        //分片时长达到fragment_ms后切片
+        FragmentDuration = 1,
+        //每个gop一个分片，带宽开销最小
+        FragmentGop = 2,
+        //CMAF chunk模式，每个gop为一个CMAF fragment，其中每fragment_ms(为0则每帧)输出一个chunk(moof+mdat)
+        FragmentCMAF = 3,
+    };
+
     MP4MuxerMemory();
     ~MP4MuxerMemory() override = default;
 
+    /**
+     * 设置分片策略，请在添加track之前设置
+     * @param mode 分片策略
+     * @param fragment_ms 分片(chunk)时长，单位毫秒
+     */
+    void setFragmentMode(FragmentMode mode, uint32_t fragment_ms = 0);
+
     /**
      * 重置所有track
      */
@@ -95,18 +127,31 @@ public:
 protected:
     /**
      * 输出fmp4切片回调函数
-     * @param string 切片内容
+     * @param segment 切片内容，可能包含多个sample，moof等box头之后为帧数据的引用，帧数据不拷贝
      * @param stamp 切片末尾时间戳
-     * @param key_frame 是否有关键帧
+     * @param key_frame 是否以关键帧开始
      */
-    virtual void onSegmentData(const string &string, uint32_t stamp, bool key_frame) = 0;
+    virtual void onSegmentData(List<Buffer::Ptr> segment, uint32_t stamp, bool key_frame) = 0;
 
 protected:
     MP4FileIO::Writer createWriter() override;
+    void writeSample(int track_id, List<Frame::Ptr> &frames, bool add_nalu_size, int64_t pts, int64_t dts, bool key) override;
+
+private:
+    bool needNewFragment(bool video_key, int64_t dts) const;
+    void flushFragment();
 
 private:
-    bool _key_frame = false;
-    Ticker _ticker;
+    FragmentMode _fragment_mode = FragmentPerFrame;
+    uint32_t _fragment_ms = 0;
+    //当前分片的sample个数
+    size_t _fragment_samples = 0;
+    //当前分片是否以关键帧开始
+    bool _fragment_key = false;
+    //当前分片第一个sample的dts
+    int64_t _fragment_dts = 0;
+    //最近输入帧的时间戳
+    uint32_t _stamp = 0;
     string _init_segment;
     MP4FileMemory::Ptr _memory_file;
 };
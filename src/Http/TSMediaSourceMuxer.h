@@ -0,0 +1,124 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_TSMEDIASOURCEMUXER_H
+#define ZLMEDIAKIT_TSMEDIASOURCEMUXER_H
+
+#include "Http/TSMediaSource.h"
+#include "Http/TSMuxer.h"
+#include "Http/HlsMediaSourceMuxer.h"
+#include "Common/config.h"
+
+namespace mediakit {
+
+/**
+ * http-ts直播源复用器，同一份ts复用输出同时供给http-ts环形缓冲与hls切片器
+ */
+class TSMediaSourceMuxer : public TSMuxer,
+                           public MediaSourceEventInterceptor,
+                           public std::enable_shared_from_this<TSMediaSourceMuxer> {
+public:
+    using Ptr = std::shared_ptr<TSMediaSourceMuxer>;
+
+    /**
+     * @param hls hls切片器，为空时不生成hls
+     */
+    TSMediaSourceMuxer(const string &vhost,
+                       const string &app,
+                       const string &stream_id,
+                       HlsMediaSourceMuxer::Ptr hls = nullptr) {
+        _media_src = std::make_shared<TSMediaSource>(vhost, app, stream_id);
+        _hls = std::move(hls);
+    }
+
+    ~TSMediaSourceMuxer() override = default;
+
+    void setListener(const std::weak_ptr<MediaSourceEvent> &listener){
+        setDelegate(listener);
+        _media_src->setListener(shared_from_this());
+    }
+
+    int readerCount() const{
+        return _media_src->readerCount();
+    }
+
+    void onReaderChanged(MediaSource &sender, int size) override {
+        GET_CONFIG(bool, ts_demand, General::kTSDemand);
+        _enabled = ts_demand ? size : true;
+        if (!size && ts_demand) {
+            _clear_cache = true;
+        }
+        MediaSourceEventInterceptor::onReaderChanged(sender, size);
+    }
+
+    void inputFrame(const Frame::Ptr &frame) override {
+        GET_CONFIG(bool, ts_demand, General::kTSDemand);
+        if (_clear_cache && ts_demand) {
+            _clear_cache = false;
+            _media_src->clearCache();
+        }
+        if (isEnabled()) {
+            //http-ts与hls任意一个需要时复用ts
+            TSMuxer::inputFrame(frame);
+        }
+    }
+
+    void resetTracks() override {
+        TSMuxer::resetTracks();
+        _ring_started = false;
+        if (_hls) {
+            _hls->resetTracks();
+        }
+    }
+
+    bool isEnabled() {
+        return isRingEnabled() || (_hls && _hls->isEnabled());
+    }
+
+protected:
+    void onTs(Buffer::Ptr buffer, uint32_t stamp, bool key_frame) override {
+        if (_hls) {
+            _hls->inputTs(buffer, stamp, key_frame);
+        }
+        if (!isRingEnabled()) {
+            _ring_started = false;
+            return;
+        }
+        if (!_ring_started) {
+            //ts复用可能因hls而一直在工作，http-ts由休眠转为工作时需从关键帧开始
+            if (!key_frame) {
+                return;
+            }
+            _ring_started = true;
+        }
+        //一帧的ts数据(188字节对齐)作为一个包，由所有播放器共享，不拷贝
+        auto packet = std::make_shared<TSPacket>(std::move(buffer));
+        packet->time_stamp = stamp;
+        _media_src->onWrite(std::move(packet), key_frame);
+    }
+
+private:
+    bool isRingEnabled() {
+        GET_CONFIG(bool, ts_demand, General::kTSDemand);
+        //缓存尚未清空时，还允许触发inputFrame函数，以便及时清空缓存
+        return ts_demand ? (_clear_cache ? true : _enabled) : true;
+    }
+
+private:
+    bool _enabled = true;
+    bool _clear_cache = false;
+    bool _ring_started = false;
+    TSMediaSource::Ptr _media_src;
+    HlsMediaSourceMuxer::Ptr _hls;
+};
+
+}//namespace mediakit
+
+#endif //ZLMEDIAKIT_TSMEDIASOURCEMUXER_H
@@ -0,0 +1,211 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "TSMuxer.h"
+#include "mpeg-ts.h"
+#include "mpeg-ts-proto.h"
+#include "Extension/AAC.h"
+#include "Extension/H264.h"
+#include "Extension/H265.h"
+
+namespace mediakit {
+
+TSMuxer::TSMuxer() {
+    createContext();
+}
+
+TSMuxer::~TSMuxer() {
+    if (_context) {
+        mpeg_ts_destroy(_context);
+        _context = nullptr;
+    }
+}
+
+void TSMuxer::createContext() {
+    static mpeg_ts_func_t s_func = {
+            [](void *param, size_t bytes) -> void * {
+                TSMuxer *muxer = (TSMuxer *) param;
+                //release编译时assert为空
+                (void) bytes;
+                assert(sizeof(muxer->_tsbuf) >= bytes);
+                return muxer->_tsbuf;
+            },
+            [](void * /*param*/, void * /*packet*/) {
+                //do nothing
+            },
+            [](void *param, const void *packet, size_t bytes) -> int {
+                TSMuxer *muxer = (TSMuxer *) param;
+                //同一帧的ts包先合并，帧写完后一次性输出
+                muxer->_ts_cache.append((char *) packet, bytes);
+                return 0;
+            }
+    };
+    if (!_context) {
+        _context = mpeg_ts_create(&s_func, this);
+    }
+}
+
+bool TSMuxer::haveVideo() const {
+    return _have_video;
+}
+
+void TSMuxer::resetTracks() {
+    _have_video = false;
+    _last_pat_stamp = -1;
+    _ts_cache.clear();
+    _frame_cached.clear();
+    _codec_to_trackid.clear();
+    //通知mpeg_ts复用器，pmt已经变化
+    mpeg_ts_destroy(_context);
+    _context = nullptr;
+    createContext();
+}
+
+static int getCodec(CodecId codec_id) {
+    switch (codec_id) {
+        case CodecH264 : return PSI_STREAM_H264;
+        case CodecH265 : return PSI_STREAM_H265;
+        case CodecAAC : return PSI_STREAM_AAC;
+        case CodecG711A : return PSI_STREAM_AUDIO_G711A;
+        case CodecG711U : return PSI_STREAM_AUDIO_G711U;
+        default : return 0;
+    }
+}
+
+void TSMuxer::addTrack(const Track::Ptr &track) {
+    auto codec = getCodec(track->getCodecId());
+    if (!codec) {
+        WarnL << "mpegts不支持该编码格式:" << track->getCodecName();
+        return;
+    }
+    auto &info = _codec_to_trackid[track->getCodecId()];
+    info.track_id = mpeg_ts_add_stream(_context, codec, nullptr, 0);
+    switch (track->getTrackType()) {
+        case TrackVideo: {
+            _have_video = true;
+            //音频时间戳同步于视频
+            for (auto &pr : _codec_to_trackid) {
+                if (pr.first != track->getCodecId()) {
+                    pr.second.stamp.syncTo(info.stamp);
+                }
+            }
+            break;
+        }
+        case TrackAudio: {
+            auto aac_track = dynamic_pointer_cast<AACTrack>(track);
+            if (aac_track) {
+                info.aac_cfg = aac_track->getAacCfg();
+            }
+            for (auto &pr : _codec_to_trackid) {
+                if (pr.first != track->getCodecId() && (pr.first == CodecH264 || pr.first == CodecH265)) {
+                    info.stamp.syncTo(pr.second.stamp);
+                }
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+void TSMuxer::inputFrame(const Frame::Ptr &frame) {
+    auto it = _codec_to_trackid.find(frame->getCodecId());
+    if (it == _codec_to_trackid.end()) {
+        return;
+    }
+    auto &info = it->second;
+    switch (frame->getCodecId()) {
+        case CodecH264:
+        case CodecH265: {
+            //sps、pps、idr等时间戳相同的nalu合并为一帧写入
+            if (!_frame_cached.empty() && _frame_cached.back()->dts() != frame->dts()) {
+                flushVideo(_frame_cached.back());
+            }
+            _frame_cached.emplace_back(Frame::getCacheAbleFrame(frame));
+            break;
+        }
+
+        case CodecAAC: {
+            int64_t dts_out, pts_out;
+            info.stamp.revise(frame->dts(), frame->pts(), dts_out, pts_out);
+            if (frame->prefixSize()) {
+                writeFrame(info.track_id, frame->data(), frame->size(), pts_out, dts_out, false);
+                break;
+            }
+            //mpegts的aac需要adts头
+            string aac;
+            aac.resize(ADTS_HEADER_LEN);
+            if (dumpAacConfig(info.aac_cfg, frame->size(), (uint8_t *) aac.data(), aac.size()) != ADTS_HEADER_LEN) {
+                break;
+            }
+            aac.append(frame->data(), frame->size());
+            writeFrame(info.track_id, aac.data(), aac.size(), pts_out, dts_out, false);
+            break;
+        }
+
+        default: {
+            int64_t dts_out, pts_out;
+            info.stamp.revise(frame->dts(), frame->pts(), dts_out, pts_out);
+            writeFrame(info.track_id, frame->data() + frame->prefixSize(), frame->size() - frame->prefixSize(),
+                       pts_out, dts_out, false);
+            break;
+        }
+    }
+}
+
+void TSMuxer::flushVideo(const Frame::Ptr &back) {
+    auto &info = _codec_to_trackid[back->getCodecId()];
+    int64_t dts_out, pts_out;
+    info.stamp.revise(back->dts(), back->pts(), dts_out, pts_out);
+
+    bool key_frame = false;
+    _frame_cached.for_each([&](const Frame::Ptr &frame) {
+        key_frame |= frame->keyFrame();
+    });
+
+    if (_frame_cached.size() == 1 && back->prefixSize()) {
+        //单帧且已经是annexb格式，无需拷贝
+        writeFrame(info.track_id, back->data(), back->size(), pts_out, dts_out, key_frame);
+    } else {
+        //合并为annexb格式的一帧，没有start code的帧补上00 00 00 01
+        string merged;
+        merged.reserve(back->size() + 1024);
+        _frame_cached.for_each([&](const Frame::Ptr &frame) {
+            if (frame->prefixSize()) {
+                merged.append(frame->data(), frame->size());
+            } else {
+                merged.append("\x00\x00\x00\x01", 4);
+                merged.append(frame->data(), frame->size());
+            }
+        });
+        writeFrame(info.track_id, merged.data(), merged.size(), pts_out, dts_out, key_frame);
+    }
+    _frame_cached.clear();
+}
+
+void TSMuxer::writeFrame(int track_id, const char *data, int size, int64_t pts, int64_t dts, bool key_frame) {
+    if (!_have_video && (_last_pat_stamp < 0 || dts - _last_pat_stamp >= 1000)) {
+        //纯音频，每秒插入一次PAT/PMT，作为可独立解码的切片点
+        _last_pat_stamp = dts;
+        key_frame = true;
+    }
+    if (key_frame) {
+        //关键帧前插入PAT/PMT，方便切片或播放器从此处开始解码
+        mpeg_ts_reset(_context);
+    }
+    mpeg_ts_write(_context, track_id, key_frame ? MPEG_FLAG_IDR_FRAME : 0, pts * 90LL, dts * 90LL, data, size);
+    if (_ts_cache.empty()) {
+        return;
+    }
+    auto buffer = std::make_shared<BufferString>(std::move(_ts_cache));
+    _ts_cache.clear();
+    onTs(std::move(buffer), dts, key_frame);
+}
+
+}//namespace mediakit
@@ -0,0 +1,84 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_TSMUXER_H
+#define ZLMEDIAKIT_TSMUXER_H
+
+#include <unordered_map>
+#include "Common/MediaSink.h"
+#include "Common/Stamp.h"
+#include "Extension/Frame.h"
+#include "Network/Buffer.h"
+
+namespace mediakit {
+
+/**
+ * 基于libmpeg的mpegts复用器
+ * 每输入一帧(时间戳相同的nalu合并为一帧)输出一次ts数据
+ */
+class TSMuxer : public MediaSinkInterface {
+public:
+    TSMuxer();
+    ~TSMuxer() override;
+
+    /**
+     * 添加已经ready状态的track
+     */
+    void addTrack(const Track::Ptr &track) override;
+
+    /**
+     * 输入帧
+     */
+    void inputFrame(const Frame::Ptr &frame) override;
+
+    /**
+     * 重置所有track
+     */
+    void resetTracks() override;
+
+    /**
+     * 是否包含视频
+     */
+    bool haveVideo() const;
+
+protected:
+    /**
+     * 输出一帧的mpegts数据
+     * @param buffer 由若干个188字节的ts包组成
+     * @param stamp 帧时间戳，单位毫秒
+     * @param key_frame 是否以PAT/PMT开头并可独立解码(视频关键帧，纯音频时每秒一次)
+     */
+    virtual void onTs(Buffer::Ptr buffer, uint32_t stamp, bool key_frame) = 0;
+
+private:
+    void createContext();
+    void writeFrame(int track_id, const char *data, int size, int64_t pts, int64_t dts, bool key_frame);
+    void flushVideo(const Frame::Ptr &frame);
+
+private:
+    struct track_info {
+        int track_id = -1;
+        string aac_cfg;
+        Stamp stamp;
+    };
+
+    bool _have_video = false;
+    void *_context = nullptr;
+    //纯音频时上次插入PAT/PMT的时间戳
+    int64_t _last_pat_stamp = -1;
+    char _tsbuf[188];
+    string _ts_cache;
+    //时间戳相同的视频nalu
+    List<Frame::Ptr> _frame_cached;
+    unordered_map<int, track_info> _codec_to_trackid;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_TSMUXER_H
@@ -146,38 +146,51 @@ void WebSocketSplitter::onPayloadData(uint8_t *data, uint64_t len) {
     onWebSocketDecodePayload(*this, _mask_flag ? data - len : data, len, _payload_offset);
 }
 
-void WebSocketSplitter::encode(const WebSocketHeader &header,const Buffer::Ptr &buffer) {
-    string ret;
-    uint64_t len = buffer ? buffer->size() : 0;
-    uint8_t byte = header._fin << 7 | ((header._reserved & 0x07) << 4) | (header._opcode & 0x0F) ;
-    ret.push_back(byte);
+/**
+ * 编码websocket帧头
+ * @param out 输出缓存，长度至少为WS_MAX_HEADER_SIZE + 4
+ * @param mask 掩码，为nullptr时不加掩码
+ * @return 帧头长度
+ */
+static uint32_t encodeHeader(uint8_t *out, bool fin, uint8_t reserved, WebSocketHeader::Type opcode, const uint8_t *mask, uint64_t len) {
+    uint8_t *ptr = out;
+    *(ptr++) = fin << 7 | ((reserved & 0x07) << 4) | (opcode & 0x0F);
+
+    uint8_t byte = (mask != nullptr) << 7;
+    if (len < 126) {
+        *(ptr++) = byte | len;
+    } else if (len <= 0xFFFF) {
+        *(ptr++) = byte | 126;
+        *(ptr++) = (len >> 8) & 0xFF;
+        *(ptr++) = len & 0xFF;
+    } else {
+        *(ptr++) = byte | 127;
+        for (int i = 7; i >= 0; --i) {
+            *(ptr++) = (len >> (8 * i)) & 0xFF;
+        }
+    }
+    if (mask) {
+        memcpy(ptr, mask, 4);
+        ptr += 4;
+    }
+    return ptr - out;
+}
 
+void WebSocketSplitter::encode(const WebSocketHeader &header,const Buffer::Ptr &buffer) {
     auto mask_flag = (header._mask_flag && header._mask.size() >= 4);
-    byte = mask_flag << 7;
-
-    if(len < 126){
-        byte |= len;
-        ret.push_back(byte);
-    }else if(len <= 0xFFFF){
-        byte |= 126;
-        ret.push_back(byte);
-
-        auto len_low = htons(len);
-        ret.append((char *)&len_low,2);
-    }else{
-        byte |= 127;
-        ret.push_back(byte);
-
-        uint32_t len_high = htonl(len >> 32) ;
-        uint32_t len_low = htonl(len & 0xFFFFFFFF);
-        ret.append((char *)&len_high,4);
-        ret.append((char *)&len_low,4);
-    }
-    if(mask_flag){
-        ret.append((char *)header._mask.data(),4);
+    if (!mask_flag && header._fin && !header._reserved) {
+        auto pre_encoded = dynamic_pointer_cast<WebSocketPreEncodedBuffer>(buffer);
+        if (pre_encoded && pre_encoded->opcode() == header._opcode && !pre_encoded->tailSize()) {
+            //帧头已经预先编码，直接发送完整帧
+            onWebSocketEncodeData(WebSocketPreEncodedBuffer::getFrame(pre_encoded));
+            return;
+        }
     }
 
-    onWebSocketEncodeData(std::make_shared<BufferString>(std::move(ret)));
+    uint64_t len = buffer ? buffer->size() : 0;
+    uint8_t head[WS_MAX_HEADER_SIZE + 4];
+    auto head_len = encodeHeader(head, header._fin, header._reserved, header._opcode, mask_flag ? header._mask.data() : nullptr, len);
+    onWebSocketEncodeData(std::make_shared<BufferString>(string((char *) head, head_len)));
 
     if(len > 0){
         if(mask_flag){
@@ -188,10 +201,34 @@ void WebSocketSplitter::encode(const WebSocketHeader &header,const Buffer::Ptr &
         }
         onWebSocketEncodeData(buffer);
     }
+}
 
+///////////////////////////////////////////WebSocketPreEncodedBuffer///////////////////////////////////////////
+
+WebSocketPreEncodedBuffer::WebSocketPreEncodedBuffer(string str, WebSocketHeader::Type opcode, uint64_t tail_size) : _opcode(opcode), _tail_size(tail_size), _str(std::move(str)) {
+    if (_str.size() < WS_MAX_HEADER_SIZE) {
+        throw std::invalid_argument("WebSocketPreEncodedBuffer: no room for websocket header");
+    }
+    uint8_t head[WS_MAX_HEADER_SIZE + 4];
+    auto head_len = encodeHeader(head, true, 0, opcode, nullptr, _str.size() - WS_MAX_HEADER_SIZE + tail_size);
+    //帧头紧贴负载写入预留空间尾部，使帧头与负载连续
+    _frame._data = (char *) _str.data() + WS_MAX_HEADER_SIZE - head_len;
+    _frame._size = _str.size() - WS_MAX_HEADER_SIZE + head_len;
+    memcpy(_frame._data, head, head_len);
 }
 
+char *WebSocketPreEncodedBuffer::data() const {
+    return (char *) _str.data() + WS_MAX_HEADER_SIZE;
+}
+
+uint32_t WebSocketPreEncodedBuffer::size() const {
+    return _str.size() - WS_MAX_HEADER_SIZE;
+}
 
+Buffer::Ptr WebSocketPreEncodedBuffer::getFrame(const WebSocketPreEncodedBuffer::Ptr &self) {
+    //共享self的引用计数，指向其内部的完整帧
+    return Buffer::Ptr(self, &self->_frame);
+}
 
 } /* namespace mediakit */
 
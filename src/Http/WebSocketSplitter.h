@@ -22,6 +22,9 @@ using namespace toolkit;
 //websocket组合包最大不得超过4MB(防止内存爆炸)
 #define MAX_WS_PACKET (4 * 1024 * 1024)
 
+//不加掩码的websocket帧头最大长度
+#define WS_MAX_HEADER_SIZE 10
+
 namespace mediakit {
 
 class WebSocketHeader {
@@ -84,6 +87,58 @@ private:
     bool _fin;
 };
 
+/**
+ * 预编码websocket帧头的共享数据包
+ * 服务器下发的帧不加掩码，帧头只与opcode和负载长度有关，对所有客户端都相同，
+ * 所以在生成数据包时在负载前预留帧头空间并编码一次，所有websocket客户端直接发送这片连续内存
+ */
+class WebSocketPreEncodedBuffer : public Buffer {
+public:
+    typedef std::shared_ptr<WebSocketPreEncodedBuffer> Ptr;
+
+    /**
+     * 构造函数
+     * @param str 数据，头部WS_MAX_HEADER_SIZE个字节为预留的帧头空间，其后为负载
+     * @param opcode 帧类型
+     * @param tail_size 紧随本对象发送的其余负载长度，帧头按总负载长度编码，此时本对象只是帧的开头部分
+     */
+    WebSocketPreEncodedBuffer(string str, WebSocketHeader::Type opcode = WebSocketHeader::BINARY, uint64_t tail_size = 0);
+    ~WebSocketPreEncodedBuffer() override {}
+
+    /**
+     * 负载数据，不包含帧头，供http等非websocket方式直接发送
+     */
+    char *data() const override;
+    uint32_t size() const override;
+
+    WebSocketHeader::Type opcode() const { return _opcode; }
+    uint64_t tailSize() const { return _tail_size; }
+
+    /**
+     * 获取帧头+负载的完整websocket帧
+     * 返回对象与self共享生命周期，不开辟内存也不拷贝数据
+     * @param self 本对象的智能指针
+     */
+    static Buffer::Ptr getFrame(const WebSocketPreEncodedBuffer::Ptr &self);
+
+private:
+    class FrameBuffer : public Buffer {
+    public:
+        char *data() const override { return _data; }
+        uint32_t size() const override { return _size; }
+
+    public:
+        char *_data = nullptr;
+        uint32_t _size = 0;
+    };
+
+private:
+    WebSocketHeader::Type _opcode;
+    uint64_t _tail_size;
+    string _str;
+    FrameBuffer _frame;
+};
+
 class WebSocketSplitter : public WebSocketHeader{
 public:
     WebSocketSplitter(){}
@@ -99,7 +154,8 @@ public:
 
     /**
      * 编码一个数据包
-     * 将触发2次onWebSocketEncodeData回调
+     * 将触发2次onWebSocketEncodeData回调；
+     * 如果buffer为opcode相同的WebSocketPreEncodedBuffer且无需掩码，则直接输出预编码的完整帧，只触发1次回调
      * @param header 数据头
      * @param buffer 负载数据
      */
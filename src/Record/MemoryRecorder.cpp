@@ -0,0 +1,41 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "MemoryRecorder.h"
+#include "Config.h"
+
+namespace mediakit {
+
+MemoryRecorder::MemoryRecorder(const string &vhost, const string &app, const string &stream_id) {
+    //录像不需要逐帧低延时，按时长分片以减少box开销，分片总是以关键帧开始
+    setFragmentMode(FragmentDuration, ConfigInfo.record.fragment_duration);
+    _stream = RecordPool::Instance().addStream(vhost, app, stream_id);
+}
+
+MemoryRecorder::~MemoryRecorder() {
+    RecordPool::Instance().removeStream(_stream);
+}
+
+void MemoryRecorder::onAllTrackReady() {
+    RecordPool::Instance().setInitSegment(_stream, getInitSegment());
+}
+
+void MemoryRecorder::resetTracks() {
+    MP4MuxerMemory::resetTracks();
+    RecordPool::Instance().sealSegment(_stream);
+}
+
+void MemoryRecorder::onSegmentData(List<Buffer::Ptr> segment, uint32_t stamp, bool key_frame) {
+    auto packet = std::make_shared<FMP4Packet>(std::move(segment));
+    packet->time_stamp = stamp;
+    RecordPool::Instance().inputFragment(_stream, std::move(packet), key_frame);
+}
+
+}//namespace mediakit
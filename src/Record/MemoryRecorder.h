@@ -0,0 +1,48 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_MEMORYRECORDER_H
+#define ZLMEDIAKIT_MEMORYRECORDER_H
+
+#include "Http/MP4Muxer.h"
+#include "Record/RecordPool.h"
+
+namespace mediakit {
+
+/**
+ * 内存录像复用器，把一路流复用为fmp4分片保存在全局内存录像池中，
+ * 分片引用帧数据，不拷贝
+ */
+class MemoryRecorder : public MP4MuxerMemory {
+public:
+    using Ptr = std::shared_ptr<MemoryRecorder>;
+
+    MemoryRecorder(const string &vhost, const string &app, const string &stream_id);
+    ~MemoryRecorder() override;
+
+    /**
+     * 所有track添加完毕
+     */
+    void onAllTrackReady();
+
+    /**
+     * 重置所有track，结束当前录像切片
+     */
+    void resetTracks() override;
+
+protected:
+    void onSegmentData(List<Buffer::Ptr> segment, uint32_t stamp, bool key_frame) override;
+
+private:
+    RecordStream::Ptr _stream;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_MEMORYRECORDER_H
@@ -0,0 +1,412 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "RecordPool.h"
+#include "Config.h"
+#include "Util/File.h"
+#include "Util/util.h"
+#include "Util/logger.h"
+
+namespace mediakit {
+
+RecordSegment::RecordSegment(std::shared_ptr<const string> init_segment, uint64_t start_utc_ms, uint32_t start_stamp) {
+    _init_segment = std::move(init_segment);
+    _start_utc_ms = _end_utc_ms = start_utc_ms;
+    _start_stamp = start_stamp;
+    _bytes = _init_segment ? _init_segment->size() : 0;
+    RecordPool::Instance()._bytes_buffered += _bytes;
+}
+
+RecordSegment::~RecordSegment() {
+    RecordPool::Instance()._bytes_buffered -= _bytes;
+}
+
+void RecordSegment::append(RecordFragment fragment) {
+    auto bytes = fragment.packet->size();
+    _end_utc_ms = fragment.utc_ms;
+    _bytes += bytes;
+    RecordPool::Instance()._bytes_buffered += bytes;
+    _fragments.emplace_back(std::move(fragment));
+}
+
+void RecordSegment::seal() {
+    _sealed = true;
+}
+
+void RecordSegment::setSuccessor(RecordSegment::Ptr next, size_t offset) {
+    _successor = std::move(next);
+    _successor_offset = offset;
+}
+
+uint32_t RecordSegment::duration() const {
+    if (_fragments.empty()) {
+        return 0;
+    }
+    //分片时间戳为其结束时间戳
+    return _fragments.back().packet->time_stamp - _start_stamp;
+}
+
+uint64_t RecordSegment::fragmentStartUtc(size_t index) const {
+    auto &fragment = _fragments[index];
+    auto start_stamp = index ? _fragments[index - 1].packet->time_stamp : _start_stamp;
+    return fragment.utc_ms - (uint32_t) (fragment.packet->time_stamp - start_stamp);
+}
+
+bool RecordSegment::save(const string &path) const {
+    auto fp = File::create_file(path.data(), "wb");
+    if (!fp) {
+        WarnL << "创建录像文件失败:" << path << " " << get_uv_errmsg();
+        return false;
+    }
+    bool ok = true;
+    auto write = [&](const char *data, size_t size) {
+        if (ok && fwrite(data, 1, size, fp) != size) {
+            ok = false;
+        }
+    };
+    if (_init_segment) {
+        write(_init_segment->data(), _init_segment->size());
+    }
+    for (auto &fragment : _fragments) {
+        //分片数据直接从帧缓存写入文件，不合并拷贝
+        fragment.packet->for_each(false, [&](const Buffer::Ptr &buf, bool /*last*/) {
+            write(buf->data(), buf->size());
+        });
+    }
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        WarnL << "写录像文件失败:" << path << " " << get_uv_errmsg();
+        File::delete_file(path.data());
+    }
+    return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+INSTANCE_IMP(RecordPool);
+
+RecordPool::RecordPool() {
+    auto threads = ConfigInfo.record.flush_threads ? ConfigInfo.record.flush_threads : 1;
+    //落盘优先级低于媒体线程
+    _flush_pool = std::make_shared<ThreadPool>(threads, ThreadPool::PRIORITY_LOWEST, true);
+}
+
+//纯音频切片的任意分片都可以开始播放
+static bool isRandomAccess(const RecordSegment &segment, size_t index) {
+    auto &fragments = segment.fragments();
+    return fragments[index].key || !fragments.front().key;
+}
+
+static string getStreamKey(const string &vhost, const string &app, const string &stream) {
+    return vhost + "/" + app + "/" + stream;
+}
+
+RecordStream::Ptr RecordPool::addStream(const string &vhost, const string &app, const string &stream) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    auto &ref = _streams[getStreamKey(vhost, app, stream)];
+    if (!ref) {
+        ref = std::make_shared<RecordStream>(vhost, app, stream);
+    }
+    ref->_alive = true;
+    return ref;
+}
+
+void RecordPool::removeStream(const RecordStream::Ptr &stream) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    sealSegment_l(stream);
+    stream->_alive = false;
+    if (stream->_segments.empty()) {
+        _streams.erase(getStreamKey(stream->_vhost, stream->_app, stream->_stream));
+    }
+}
+
+RecordStream::Ptr RecordPool::findStream(const string &vhost, const string &app, const string &stream) const {
+    lock_guard<recursive_mutex> lck(_mtx);
+    auto it = _streams.find(getStreamKey(vhost, app, stream));
+    return it == _streams.end() ? nullptr : it->second;
+}
+
+void RecordPool::setInitSegment(const RecordStream::Ptr &stream, string init_segment) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    //track变化后之前的分片不能再与新的init segment拼接
+    sealSegment_l(stream);
+    stream->_init_segment = std::make_shared<const string>(std::move(init_segment));
+    stream->_have_stamp = false;
+}
+
+void RecordPool::inputFragment(const RecordStream::Ptr &stream, FMP4Packet::Ptr packet, bool key) {
+    auto segment_ms = ConfigInfo.record.segment_duration * 1000;
+    auto now = getCurrentMillisecond(true);
+    lock_guard<recursive_mutex> lck(_mtx);
+    auto &current = stream->_current;
+    //切片在关键帧处结束，纯音频时按时长结束
+    if (current && (key || !current->fragments().front().key) && current->duration() >= segment_ms) {
+        sealSegment_l(stream);
+    }
+    if (!current) {
+        auto start_stamp = stream->_have_stamp ? stream->_last_stamp : packet->time_stamp;
+        current = std::make_shared<RecordSegment>(stream->_init_segment, now, start_stamp);
+        _window_bytes += current->bytes();
+    }
+    stream->_have_stamp = true;
+    stream->_last_stamp = packet->time_stamp;
+    _window_bytes += packet->size();
+    current->append(RecordFragment{std::move(packet), key, now});
+    if (!stream->_open && current->fragments().size() > 1 && isRandomAccess(*current, current->fragments().size() - 1)) {
+        updateOpen_l(stream);
+    }
+    shrink_l();
+}
+
+void RecordPool::sealSegment(const RecordStream::Ptr &stream) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    sealSegment_l(stream);
+}
+
+void RecordPool::sealSegment_l(const RecordStream::Ptr &stream) {
+    if (!stream->_current) {
+        return;
+    }
+    auto segment = std::move(stream->_current);
+    stream->_current = nullptr;
+    updateOpen_l(stream);
+    segment->seal();
+    stream->_segments.emplace_back(segment);
+    _sealed.emplace_back(stream, segment);
+    ++_window_segments;
+    if (!ConfigInfo.record.local_path.empty()) {
+        flush(*stream, segment);
+    }
+}
+
+void RecordPool::popOldest_l() {
+    auto pr = std::move(_sealed.front());
+    _sealed.pop_front();
+    auto &stream = pr.first;
+    auto &segment = pr.second;
+    //各流的切片与全局队列的结束顺序一致，所以必定是该流最老的切片
+    stream->_segments.pop_front();
+    _window_bytes -= segment->bytes();
+    --_window_segments;
+    if (!stream->_alive && stream->_segments.empty() && !stream->_current) {
+        _streams.erase(getStreamKey(stream->_vhost, stream->_app, stream->_stream));
+    }
+}
+
+void RecordPool::shrink_l() {
+    if (ConfigInfo.record.enabled_time_quota && ConfigInfo.record.time_quota) {
+        //超过保留时长的切片移出窗口
+        auto expire_utc = getCurrentMillisecond(true) - ConfigInfo.record.time_quota;
+        while (!_sealed.empty() && _sealed.front().second->endUtc() < expire_utc) {
+            ++_expirations;
+            popOldest_l();
+        }
+    }
+
+    auto quota = ConfigInfo.record.memory_quota;
+    while (quota && _window_bytes > quota) {
+        //超过内存上限，跨流淘汰最老的数据，可能是已结束的切片，也可能是正在写入的切片的第一个gop
+        if (!_sealed.empty() && (_open.empty() || _sealed.front().second->startUtc() <= _open.begin()->first)) {
+            auto &segment = _sealed.front().second;
+            segment->setEvicted();
+            ++_evictions;
+            _evicted_bytes += segment->bytes();
+            popOldest_l();
+            continue;
+        }
+        if (!_open.empty()) {
+            splitOldest_l();
+            continue;
+        }
+        //只剩各流最新的gop，无法再淘汰
+        auto now = getCurrentMillisecond();
+        if (now - _quota_warn_ms > 10 * 1000) {
+            _quota_warn_ms = now;
+            WarnL << "内存录像上限过小，无法容纳各流最新的gop:" << _window_bytes << " > " << quota;
+        }
+        break;
+    }
+}
+
+void RecordPool::updateOpen_l(const RecordStream::Ptr &stream) {
+    if (stream->_open) {
+        _open.erase(stream->_open_it);
+        stream->_open = false;
+    }
+    auto &current = stream->_current;
+    if (!current) {
+        return;
+    }
+    auto &fragments = current->fragments();
+    for (size_t i = 1; i < fragments.size(); ++i) {
+        if (isRandomAccess(*current, i)) {
+            stream->_open_it = _open.emplace(current->startUtc(), stream);
+            stream->_open = true;
+            return;
+        }
+    }
+}
+
+void RecordPool::splitOldest_l() {
+    auto stream = _open.begin()->second;
+    auto segment = std::move(stream->_current);
+    auto &fragments = segment->fragments();
+    size_t index = 1;
+    while (!isRandomAccess(*segment, index)) {
+        ++index;
+    }
+    //从第二个可播放点开始的分片由新切片继续写入，分片数据共享不拷贝
+    auto &current = stream->_current;
+    current = std::make_shared<RecordSegment>(segment->initSegment(), fragments[index].utc_ms, fragments[index - 1].packet->time_stamp);
+    for (auto i = index; i < fragments.size(); ++i) {
+        current->append(fragments[i]);
+    }
+    //游标读到拆分处后切换到新切片
+    segment->setSuccessor(current, index);
+    segment->setEvicted();
+    updateOpen_l(stream);
+
+    auto evicted = segment->bytes() - current->bytes();
+    _window_bytes -= evicted;
+    ++_evictions;
+    _evicted_bytes += evicted;
+
+    if (!ConfigInfo.record.local_path.empty()) {
+        //被淘汰的gop还没有落盘，单独保存
+        auto head = std::make_shared<RecordSegment>(segment->initSegment(), segment->startUtc(), segment->startStamp());
+        for (size_t i = 0; i < index; ++i) {
+            head->append(fragments[i]);
+        }
+        head->seal();
+        flush(*stream, head);
+    }
+}
+
+void RecordPool::flush(const RecordStream &stream, const RecordSegment::Ptr &segment) {
+    //文件名精确到毫秒，避免流重置后新切片覆盖同一秒内的旧切片
+    char ms[16];
+    snprintf(ms, sizeof(ms), "-%03d.mp4", (int) (segment->startUtc() % 1000));
+    auto path = ConfigInfo.record.local_path + "/" + stream._app + "/" + stream._stream + "/" +
+                getTimeStr("%Y-%m-%d/%H-%M-%S", segment->startUtc() / 1000) + ms;
+    ++_flush_pending;
+    auto start = getCurrentMillisecond();
+    _flush_pool->async([this, segment, path, start]() {
+        --_flush_pending;
+        if (segment->evicted()) {
+            //落盘积压导致切片已被淘汰，放弃落盘以尽快释放内存
+            ++_flush_dropped;
+            return;
+        }
+        if (!segment->save(path)) {
+            ++_flush_failed;
+            return;
+        }
+        auto latency = getCurrentMillisecond() - start;
+        ++_flushed;
+        _flushed_bytes += segment->bytes();
+        _flush_latency_total += latency;
+        auto max = _flush_latency_max.load();
+        while (latency > max && !_flush_latency_max.compare_exchange_weak(max, latency));
+    }, false);
+}
+
+bool RecordPool::seek(const RecordStream::Ptr &stream, uint64_t utc_ms, RecordCursor &cursor, uint64_t &start_utc_ms) const {
+    lock_guard<recursive_mutex> lck(_mtx);
+    bool found = false;
+    auto check = [&](const RecordSegment::Ptr &segment) {
+        if (!segment) {
+            return;
+        }
+        auto &fragments = segment->fragments();
+        for (size_t i = 0; i < fragments.size(); ++i) {
+            if (!isRandomAccess(*segment, i)) {
+                continue;
+            }
+            auto start = segment->fragmentStartUtc(i);
+            if (found && start > utc_ms) {
+                return;
+            }
+            //第一个关键帧总是作为候选，避免请求时间早于窗口时无法播放
+            found = true;
+            cursor.segment = segment;
+            cursor.index = i;
+            start_utc_ms = start;
+        }
+    };
+    for (auto &segment : stream->_segments) {
+        check(segment);
+    }
+    check(stream->_current);
+    return found;
+}
+
+bool RecordPool::read(const RecordStream::Ptr &stream, RecordCursor &cursor, RecordFragment &fragment) const {
+    lock_guard<recursive_mutex> lck(_mtx);
+    while (cursor.segment) {
+        if (cursor.segment->successor() && cursor.index >= cursor.segment->successorOffset()) {
+            //正在写入的切片已被拆分
+            cursor.index -= cursor.segment->successorOffset();
+            cursor.segment = RecordSegment::Ptr(cursor.segment->successor());
+            continue;
+        }
+        if (cursor.index < cursor.segment->fragments().size()) {
+            fragment = cursor.segment->fragments()[cursor.index];
+            return true;
+        }
+        if (!cursor.segment->sealed()) {
+            //正在写入的切片，等待新的分片
+            return false;
+        }
+        auto next = nextSegment_l(*stream, cursor.segment);
+        if (!next) {
+            return false;
+        }
+        cursor.segment = std::move(next);
+        cursor.index = 0;
+    }
+    return false;
+}
+
+RecordSegment::Ptr RecordPool::nextSegment_l(const RecordStream &stream, const RecordSegment::Ptr &segment) const {
+    auto &segments = stream._segments;
+    for (auto it = segments.begin(); it != segments.end(); ++it) {
+        if (*it == segment) {
+            ++it;
+            return it == segments.end() ? stream._current : *it;
+        }
+    }
+    //游标所在切片已被淘汰，从窗口中最老的切片继续
+    return segments.empty() ? stream._current : segments.front();
+}
+
+RecordStatistic RecordPool::getStatistic() const {
+    RecordStatistic ret;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        ret.window_bytes = _window_bytes;
+        ret.window_segments = _window_segments;
+        ret.evictions = _evictions;
+        ret.evicted_bytes = _evicted_bytes;
+        ret.expirations = _expirations;
+    }
+    ret.bytes_buffered = _bytes_buffered;
+    ret.flushed = _flushed;
+    ret.flush_failed = _flush_failed;
+    ret.flushed_bytes = _flushed_bytes;
+    ret.flush_pending = _flush_pending;
+    ret.flush_dropped = _flush_dropped;
+    ret.flush_latency_avg_ms = ret.flushed ? _flush_latency_total / ret.flushed : 0;
+    ret.flush_latency_max_ms = _flush_latency_max;
+    return ret;
+}
+
+}//namespace mediakit
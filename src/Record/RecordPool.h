@@ -0,0 +1,269 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_RECORDPOOL_H
+#define ZLMEDIAKIT_RECORDPOOL_H
+
+#include <mutex>
+#include <map>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include "Http/FMP4MediaSource.h"
+#include "Thread/ThreadPool.h"
+
+namespace mediakit {
+
+//录像中的一个fmp4分片，分片数据与直播共享，不拷贝
+struct RecordFragment {
+    FMP4Packet::Ptr packet;
+    //是否以关键帧开始
+    bool key = false;
+    //分片生成时的系统时间(毫秒)
+    uint64_t utc_ms = 0;
+};
+
+/**
+ * 一个录像切片，由init segment与若干fmp4分片组成，以关键帧开始，可以直接保存为fmp4文件；
+ * 切片结束(seal)后数据不再修改，可以在落盘线程中安全读取
+ */
+class RecordSegment {
+public:
+    using Ptr = std::shared_ptr<RecordSegment>;
+
+    /**
+     * 构造函数
+     * @param init_segment fmp4 init segment
+     * @param start_utc_ms 切片开始的系统时间
+     * @param start_stamp 切片开始的时间戳，即上个分片的结束时间戳
+     */
+    RecordSegment(std::shared_ptr<const string> init_segment, uint64_t start_utc_ms, uint32_t start_stamp);
+    ~RecordSegment();
+
+    void append(RecordFragment fragment);
+    void seal();
+
+    /**
+     * 保存为fmp4文件
+     * @param path 文件路径
+     * @return 是否成功
+     */
+    bool save(const string &path) const;
+
+    uint64_t bytes() const { return _bytes; }
+    uint64_t startUtc() const { return _start_utc_ms; }
+    uint64_t endUtc() const { return _end_utc_ms; }
+    uint32_t startStamp() const { return _start_stamp; }
+    uint32_t duration() const;
+
+    /**
+     * 获取分片开始的系统时间，由分片时长推算
+     * @param index 分片索引
+     */
+    uint64_t fragmentStartUtc(size_t index) const;
+    bool sealed() const { return _sealed; }
+    const std::shared_ptr<const string> &initSegment() const { return _init_segment; }
+    const std::vector<RecordFragment> &fragments() const { return _fragments; }
+
+    //淘汰后尚未开始的落盘任务会被放弃
+    void setEvicted() { _evicted = true; }
+    bool evicted() const { return _evicted; }
+
+    /**
+     * 正在写入的切片超过内存上限时在关键帧处拆分，前面的分片移出窗口，之后的分片由新切片继续写入
+     * @param next 新切片
+     * @param offset 新切片第一个分片在本切片中的索引
+     */
+    void setSuccessor(RecordSegment::Ptr next, size_t offset);
+    const RecordSegment::Ptr &successor() const { return _successor; }
+    size_t successorOffset() const { return _successor_offset; }
+
+private:
+    bool _sealed = false;
+    std::atomic_bool _evicted{false};
+    uint64_t _bytes = 0;
+    uint64_t _start_utc_ms;
+    uint64_t _end_utc_ms;
+    uint32_t _start_stamp;
+    std::shared_ptr<const string> _init_segment;
+    std::vector<RecordFragment> _fragments;
+    size_t _successor_offset = 0;
+    RecordSegment::Ptr _successor;
+};
+
+//一路流的内存录像窗口，成员由RecordPool的锁保护
+class RecordStream {
+public:
+    using Ptr = std::shared_ptr<RecordStream>;
+
+    RecordStream(string vhost, string app, string stream)
+        : _vhost(std::move(vhost)), _app(std::move(app)), _stream(std::move(stream)) {}
+    ~RecordStream() = default;
+
+    const string &getVhost() const { return _vhost; }
+    const string &getApp() const { return _app; }
+    const string &getStream() const { return _stream; }
+
+private:
+    friend class RecordPool;
+    string _vhost;
+    string _app;
+    string _stream;
+    //复用器是否还在写入
+    bool _alive = true;
+    //最近一个分片的时间戳
+    bool _have_stamp = false;
+    uint32_t _last_stamp = 0;
+    std::shared_ptr<const string> _init_segment;
+    RecordSegment::Ptr _current;
+    //当前切片含有多个可播放点时可以被拆分淘汰，记录其在RecordPool::_open中的位置
+    bool _open = false;
+    std::multimap<uint64_t, RecordStream::Ptr>::iterator _open_it;
+    //已结束的切片，从旧到新
+    std::deque<RecordSegment::Ptr> _segments;
+};
+
+//时移播放游标，指向窗口中的一个分片
+struct RecordCursor {
+    RecordSegment::Ptr segment;
+    size_t index = 0;
+};
+
+//内存录像统计
+struct RecordStatistic {
+    //内存中的录像数据字节数，包括等待落盘的切片
+    uint64_t bytes_buffered = 0;
+    //内存录像窗口中的字节数与切片个数
+    uint64_t window_bytes = 0;
+    uint64_t window_segments = 0;
+    //超过内存上限被淘汰的切片个数与字节数
+    uint64_t evictions = 0;
+    uint64_t evicted_bytes = 0;
+    //超过保留时长被移出窗口的切片个数
+    uint64_t expirations = 0;
+    //落盘成功、失败个数以及落盘字节数
+    uint64_t flushed = 0;
+    uint64_t flush_failed = 0;
+    uint64_t flushed_bytes = 0;
+    //等待落盘以及因淘汰而放弃落盘的切片个数
+    uint64_t flush_pending = 0;
+    uint64_t flush_dropped = 0;
+    //切片结束到落盘完成的延时(毫秒)
+    uint64_t flush_latency_avg_ms = 0;
+    uint64_t flush_latency_max_ms = 0;
+};
+
+/**
+ * 全局内存录像池
+ * 所有流的录像切片共享一个内存上限，超过后跨流淘汰最老的切片，正在写入的切片在关键帧处拆分淘汰，每路流至少保留最新的gop；
+ * 结束的切片在专用的落盘线程池中写入磁盘，媒体线程不会阻塞在磁盘io上
+ */
+class RecordPool {
+public:
+    ~RecordPool() = default;
+    static RecordPool &Instance();
+
+    /**
+     * 添加一路录像，已存在时复用其窗口
+     */
+    RecordStream::Ptr addStream(const string &vhost, const string &app, const string &stream);
+
+    /**
+     * 录像复用器销毁，结束当前切片，窗口中的切片保留至过期或被淘汰
+     */
+    void removeStream(const RecordStream::Ptr &stream);
+
+    /**
+     * 查找一路录像
+     */
+    RecordStream::Ptr findStream(const string &vhost, const string &app, const string &stream) const;
+
+    /**
+     * 设置init segment，track变化时结束当前切片
+     */
+    void setInitSegment(const RecordStream::Ptr &stream, string init_segment);
+
+    /**
+     * 输入fmp4分片
+     * @param stream 录像
+     * @param packet 分片
+     * @param key 是否以关键帧开始
+     */
+    void inputFragment(const RecordStream::Ptr &stream, FMP4Packet::Ptr packet, bool key);
+
+    /**
+     * 结束当前切片
+     */
+    void sealSegment(const RecordStream::Ptr &stream);
+
+    /**
+     * 定位时移播放位置，为不晚于该时间的最近一个关键帧分片，早于窗口时定位到窗口中最老的关键帧
+     * @param stream 录像
+     * @param utc_ms 开始播放的系统时间
+     * @param cursor 游标
+     * @param start_utc_ms 定位到的分片的开始时间
+     * @return 窗口中没有可播放的分片时返回false
+     */
+    bool seek(const RecordStream::Ptr &stream, uint64_t utc_ms, RecordCursor &cursor, uint64_t &start_utc_ms) const;
+
+    /**
+     * 读取游标处的分片，不移动游标，读取后请自增cursor.index；
+     * 游标所在切片读完后自动切换到下一个切片，游标所在切片已移出窗口时从窗口中最老的切片继续
+     * @param stream 录像
+     * @param cursor 游标
+     * @param fragment 分片，与窗口共享数据
+     * @return 已读到窗口最新处时返回false
+     */
+    bool read(const RecordStream::Ptr &stream, RecordCursor &cursor, RecordFragment &fragment) const;
+
+    RecordStatistic getStatistic() const;
+
+private:
+    RecordPool();
+    RecordSegment::Ptr nextSegment_l(const RecordStream &stream, const RecordSegment::Ptr &segment) const;
+    void sealSegment_l(const RecordStream::Ptr &stream);
+    void shrink_l();
+    void popOldest_l();
+    void splitOldest_l();
+    void updateOpen_l(const RecordStream::Ptr &stream);
+    void flush(const RecordStream &stream, const RecordSegment::Ptr &segment);
+
+private:
+    friend class RecordSegment;
+    //切片析构时更新，需要先于切片容器构造
+    std::atomic<uint64_t> _bytes_buffered{0};
+    std::atomic<uint64_t> _flushed{0};
+    std::atomic<uint64_t> _flush_failed{0};
+    std::atomic<uint64_t> _flushed_bytes{0};
+    std::atomic<uint64_t> _flush_pending{0};
+    std::atomic<uint64_t> _flush_dropped{0};
+    std::atomic<uint64_t> _flush_latency_total{0};
+    std::atomic<uint64_t> _flush_latency_max{0};
+
+    mutable std::recursive_mutex _mtx;
+    uint64_t _window_bytes = 0;
+    uint64_t _window_segments = 0;
+    uint64_t _evictions = 0;
+    uint64_t _evicted_bytes = 0;
+    uint64_t _expirations = 0;
+    //所有流已结束的切片，按结束顺序从旧到新
+    std::deque<std::pair<RecordStream::Ptr, RecordSegment::Ptr> > _sealed;
+    //可以拆分淘汰的当前切片，按开始时间从旧到新
+    std::multimap<uint64_t, RecordStream::Ptr> _open;
+    //无法降到内存上限时的告警时间
+    uint64_t _quota_warn_ms = 0;
+    std::unordered_map<string, RecordStream::Ptr> _streams;
+    //落盘线程池，最先析构以等待落盘任务结束
+    std::shared_ptr<ThreadPool> _flush_pool;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_RECORDPOOL_H
@@ -0,0 +1,124 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "TimeShiftReader.h"
+#include "Config.h"
+#include "Util/util.h"
+#include "Util/logger.h"
+
+namespace mediakit {
+
+//读取定时器间隔
+static constexpr uint64_t kTimerMS = 100;
+//追赶倍速上限
+static constexpr float kMaxSpeed = 16;
+
+TimeShiftReader::Ptr TimeShiftReader::create(const RecordStream::Ptr &stream, uint64_t start_utc_ms, float speed) {
+    RecordCursor cursor;
+    uint64_t utc_ms = 0;
+    if (!stream || !RecordPool::Instance().seek(stream, start_utc_ms, cursor, utc_ms)) {
+        return nullptr;
+    }
+    Ptr ret(new TimeShiftReader(stream, std::move(cursor), std::min(std::max(speed, 1.0f), kMaxSpeed)));
+    ret->_start_utc_ms = utc_ms;
+    ret->_last_utc_ms = utc_ms;
+    return ret;
+}
+
+TimeShiftReader::TimeShiftReader(RecordStream::Ptr stream, RecordCursor cursor, float speed) {
+    _stream = std::move(stream);
+    _cursor = std::move(cursor);
+    _speed = speed;
+    _init_segment = _cursor.segment->initSegment();
+}
+
+TimeShiftReader::~TimeShiftReader() {
+    if (_timer) {
+        _timer->cancel();
+    }
+}
+
+void TimeShiftReader::start(const EventPoller::Ptr &poller, onRead read_cb, onDetach detach_cb, onCheckPause pause_cb) {
+    _read_cb = std::move(read_cb);
+    _detach_cb = std::move(detach_cb);
+    _pause_cb = std::move(pause_cb);
+    _start_tick = getCurrentMillisecond();
+    weak_ptr<TimeShiftReader> weak_self = shared_from_this();
+    _timer = poller->doDelayTask(kTimerMS, [weak_self]() -> uint64_t {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return 0;
+        }
+        return strong_self->onTimer() ? kTimerMS : 0;
+    });
+    //立即发送开始处的分片，不等待定时器
+    onTimer();
+}
+
+void TimeShiftReader::resetClock(uint64_t utc_ms, uint64_t now) {
+    _start_utc_ms = utc_ms;
+    _start_tick = now;
+}
+
+bool TimeShiftReader::onTimer() {
+    if (_pause_cb && _pause_cb()) {
+        //播放器发送拥塞，不读取也不丢弃，等待发送缓存降下来
+        _paused = true;
+        return true;
+    }
+    auto now = getCurrentMillisecond();
+    if (_paused) {
+        //暂停期间落后的进度从暂停处重新按倍速追赶，不一次性补发
+        _paused = false;
+        _live = false;
+        resetClock(_last_utc_ms, now);
+    }
+    //分片时间超过该间隔认为游标发生了跳跃(所在切片被淘汰后跳到窗口最老处，或者推流中断过)
+    auto jump_ms = 2 * ConfigInfo.record.fragment_duration + kTimerMS;
+    auto fragment_due = [&]() {
+        //按倍速推进的播放进度，提前一个分片时长发送，避免播放器缓存不足
+        return _start_utc_ms + (uint64_t) ((now - _start_tick) * _speed) + ConfigInfo.record.fragment_duration;
+    };
+    auto due = fragment_due();
+    std::vector<FMP4Packet::Ptr> packets;
+    RecordFragment fragment;
+    bool live = true;
+    while (RecordPool::Instance().read(_stream, _cursor, fragment)) {
+        if (_cursor.segment->initSegment() != _init_segment) {
+            //track变化后的分片不能再与已发送的init segment拼接
+            auto detach_cb = std::move(_detach_cb);
+            detach_cb("track changed");
+            return false;
+        }
+        if (!_live && fragment.utc_ms > _last_utc_ms + jump_ms) {
+            //游标跳跃后以新位置重新计算播放进度，否则会停顿到时钟追上跳过的时长
+            resetClock(fragment.utc_ms, now);
+            due = fragment_due();
+        }
+        if (!_live && fragment.utc_ms > due) {
+            live = false;
+            break;
+        }
+        _last_utc_ms = fragment.utc_ms;
+        packets.emplace_back(std::move(fragment.packet));
+        ++_cursor.index;
+    }
+    if (live && !_live) {
+        _live = true;
+        InfoL << "时移播放追上直播:" << _stream->getVhost() << "/" << _stream->getApp() << "/" << _stream->getStream();
+    }
+    size_t i = 0;
+    for (auto &packet : packets) {
+        _read_cb(packet, ++i == packets.size());
+    }
+    return true;
+}
+
+}//namespace mediakit
@@ -0,0 +1,97 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_TIMESHIFTREADER_H
+#define ZLMEDIAKIT_TIMESHIFTREADER_H
+
+#include <functional>
+#include "Record/RecordPool.h"
+#include "Poller/EventPoller.h"
+
+namespace mediakit {
+
+/**
+ * fmp4时移播放器的读取游标
+ * 从内存录像窗口中不晚于请求时间的最近一个关键帧开始读取分片，按倍速追赶直到窗口最新处，
+ * 此后分片一产生就发送(延时为一个录像分片时长)；分片数据与录像窗口以及其他播放器共享，不拷贝
+ */
+class TimeShiftReader : public std::enable_shared_from_this<TimeShiftReader> {
+public:
+    using Ptr = std::shared_ptr<TimeShiftReader>;
+    using onRead = function<void(const FMP4Packet::Ptr &packet, bool flush)>;
+    using onDetach = function<void(const string &reason)>;
+    //返回true时暂停读取，游标停在原处
+    using onCheckPause = function<bool()>;
+
+    /**
+     * 创建时移游标
+     * @param stream 内存录像
+     * @param start_utc_ms 开始播放的系统时间
+     * @param speed 追赶时的倍速，小于1时按1处理
+     * @return 窗口中没有可播放的分片时返回空
+     */
+    static Ptr create(const RecordStream::Ptr &stream, uint64_t start_utc_ms, float speed);
+    ~TimeShiftReader();
+
+    /**
+     * 获取fmp4 init segment，需要先于分片发送
+     */
+    const std::shared_ptr<const string> &getInitSegment() const {
+        return _init_segment;
+    }
+
+    /**
+     * 获取实际开始播放的系统时间，即关键帧分片的开始时间
+     */
+    uint64_t getStartUtc() const {
+        return _start_utc_ms;
+    }
+
+    /**
+     * 是否已经追上窗口最新处
+     */
+    bool isLive() const {
+        return _live;
+    }
+
+    /**
+     * 开始读取，回调都在poller线程触发
+     * @param poller 播放器所在线程
+     * @param read_cb 分片回调
+     * @param detach_cb 无法继续播放时回调，比如track发生变化
+     * @param pause_cb 每次读取前回调，用于播放器发送拥塞时暂停读取
+     */
+    void start(const EventPoller::Ptr &poller, onRead read_cb, onDetach detach_cb, onCheckPause pause_cb = nullptr);
+
+private:
+    TimeShiftReader(RecordStream::Ptr stream, RecordCursor cursor, float speed);
+    bool onTimer();
+    //以该分片时间重新开始计算倍速播放进度
+    void resetClock(uint64_t utc_ms, uint64_t now);
+
+private:
+    bool _live = false;
+    bool _paused = false;
+    float _speed;
+    uint64_t _start_utc_ms;
+    uint64_t _start_tick = 0;
+    //最后发送的分片时间
+    uint64_t _last_utc_ms = 0;
+    RecordStream::Ptr _stream;
+    RecordCursor _cursor;
+    std::shared_ptr<const string> _init_segment;
+    onRead _read_cb;
+    onDetach _detach_cb;
+    onCheckPause _pause_cb;
+    DelayTask::Ptr _timer;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_TIMESHIFTREADER_H
@@ -10,7 +10,6 @@
 
 #include "FlvMuxer.h"
 #include "Util/File.h"
-#include "Rtmp/utils.h"
 
 #define FILE_BUF_SIZE (64 * 1024)
 
@@ -42,7 +41,8 @@ void FlvMuxer::start(const EventPoller::Ptr &poller,const RtmpMediaSource::Ptr &
     onWriteFlvHeader(media);
 
     std::weak_ptr<FlvMuxer> weakSelf = getSharedPtr();
-    _ring_reader = media->getRing()->attach(poller);
+    //flv tag由媒体源统一序列化，此处只需把共享的flv包写入即可
+    _ring_reader = media->getFlvRing()->attach(poller);
     _ring_reader->setDetachCB([weakSelf](){
         auto strongSelf = weakSelf.lock();
         if(!strongSelf){
@@ -51,19 +51,12 @@ void FlvMuxer::start(const EventPoller::Ptr &poller,const RtmpMediaSource::Ptr &
         strongSelf->onDetach();
     });
 
-    //音频同步于视频
-    _stamp[0].syncTo(_stamp[1]);
-    _ring_reader->setReadCB([weakSelf](const RtmpMediaSource::RingDataType &pkt){
+    _ring_reader->setReadKeyCB([weakSelf](const RtmpMediaSource::FlvRingDataType &pkt, bool is_key){
         auto strongSelf = weakSelf.lock();
-        if(!strongSelf){
+        if(!strongSelf || strongSelf->dropPacket(is_key)){
             return;
         }
-
-        int i = 0;
-        int size = pkt->size();
-        pkt->for_each([&](const RtmpPacket::Ptr &rtmp){
-            strongSelf->onWriteRtmp(rtmp, ++i == size);
-        });
+        strongSelf->onWrite(pkt, true);
     });
 }
 
@@ -91,13 +84,12 @@ void FlvMuxer::onWriteFlvHeader(const RtmpMediaSource::Ptr &mediaSrc) {
         flv_file_header[4] = 0x00;
     }
 
+    string header;
     //flv header
-    onWrite(std::make_shared<BufferRaw>(flv_file_header, sizeof(flv_file_header) - 1), false);
-
+    header.append(flv_file_header, sizeof(flv_file_header) - 1);
     auto size = htonl(0);
     //PreviousTagSize0 Always 0
-    onWrite(std::make_shared<BufferRaw>((char *)&size,4), false);
-
+    header.append((char *)&size, 4);
 
     auto &metadata = mediaSrc->getMetaData();
     if(metadata){
@@ -105,48 +97,16 @@ void FlvMuxer::onWriteFlvHeader(const RtmpMediaSource::Ptr &mediaSrc) {
         //其实metadata没什么用，有些推流器不产生metadata
         AMFEncoder invoke;
         invoke << "onMetaData" << metadata;
-        onWriteFlvTag(MSG_DATA, std::make_shared<BufferString>(invoke.data()), 0, false);
+        appendFlvTag(header, MSG_DATA, invoke.data().data(), invoke.data().size(), 0);
     }
 
     //config frame
     mediaSrc->getConfigFrame([&](const RtmpPacket::Ptr &pkt){
-        onWriteRtmp(pkt, true);
+        appendFlvTag(header, pkt->type_id, pkt->data(), pkt->size(), 0);
     });
-}
-
-
-class RtmpTagHeader {
-public:
-    uint8_t type = 0;
-    uint8_t data_size[3] = {0};
-    uint8_t timestamp[3] = {0};
-    uint8_t timestamp_ex = 0;
-    uint8_t streamid[3] = {0}; /* Always 0. */
-}PACKED;
-
-void FlvMuxer::onWriteFlvTag(const RtmpPacket::Ptr &pkt, uint32_t time_stamp , bool flush) {
-    onWriteFlvTag(pkt->type_id, pkt, time_stamp, flush);
-}
-
-void FlvMuxer::onWriteFlvTag(uint8_t type, const Buffer::Ptr &buffer, uint32_t time_stamp, bool flush) {
-    RtmpTagHeader header;
-    header.type = type;
-    set_be24(header.data_size, buffer->size());
-    header.timestamp_ex = (uint8_t) ((time_stamp >> 24) & 0xff);
-    set_be24(header.timestamp, time_stamp & 0xFFFFFF);
-    //tag header
-    onWrite(std::make_shared<BufferRaw>((char *)&header, sizeof(header)), false);
-    //tag data
-    onWrite(buffer, false);
-    auto size = htonl((buffer->size() + sizeof(header)));
-    //PreviousTagSize
-    onWrite(std::make_shared<BufferRaw>((char *)&size,4), flush);
-}
 
-void FlvMuxer::onWriteRtmp(const RtmpPacket::Ptr &pkt,bool flush) {
-    int64_t dts_out;
-    _stamp[pkt->type_id % 2].revise(pkt->time_stamp, 0, dts_out, dts_out);
-    onWriteFlvTag(pkt, dts_out,flush);
+    //flv头、metadata、config帧合并为一个包发送
+    onWrite(std::make_shared<BufferString>(std::move(header)), true);
 }
 
 void FlvMuxer::stop() {
@@ -31,17 +31,14 @@ protected:
     virtual void onWrite(const Buffer::Ptr &data, bool flush) = 0;
     virtual void onDetach() = 0;
     virtual std::shared_ptr<FlvMuxer> getSharedPtr() = 0;
+    //是否丢弃该flv包，慢速播放器可以丢帧直到下一个关键帧
+    virtual bool dropPacket(bool is_key) { return false; }
 
 private:
     void onWriteFlvHeader(const RtmpMediaSource::Ptr &media);
-    void onWriteRtmp(const RtmpPacket::Ptr &pkt, bool flush);
-    void onWriteFlvTag(const RtmpPacket::Ptr &pkt, uint32_t time_stamp, bool flush);
-    void onWriteFlvTag(uint8_t type, const Buffer::Ptr &buffer, uint32_t time_stamp, bool flush);
 
 private:
-    //时间戳修整器
-    Stamp _stamp[2];
-    RtmpMediaSource::RingType::RingReader::Ptr _ring_reader;
+    RtmpMediaSource::FlvRingType::RingReader::Ptr _ring_reader;
 };
 
 class FlvRecorder : public FlvMuxer , public std::enable_shared_from_this<FlvRecorder>{
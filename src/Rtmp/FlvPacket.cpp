@@ -0,0 +1,74 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "FlvPacket.h"
+#include "Rtmp/utils.h"
+
+//flv tag header(11字节) + PreviousTagSize(4字节)
+#define FLV_TAG_OVERHEAD (11 + 4)
+
+namespace mediakit {
+
+class RtmpTagHeader {
+public:
+    uint8_t type = 0;
+    uint8_t data_size[3] = {0};
+    uint8_t timestamp[3] = {0};
+    uint8_t timestamp_ex = 0;
+    uint8_t streamid[3] = {0}; /* Always 0. */
+}PACKED;
+
+void appendFlvTag(string &buf, uint8_t type, const char *data, uint32_t size, uint32_t time_stamp) {
+    RtmpTagHeader header;
+    header.type = type;
+    set_be24(header.data_size, size);
+    header.timestamp_ex = (uint8_t) ((time_stamp >> 24) & 0xff);
+    set_be24(header.timestamp, time_stamp & 0xFFFFFF);
+    //tag header
+    buf.append((char *) &header, sizeof(header));
+    //tag data
+    buf.append(data, size);
+    //PreviousTagSize
+    uint32_t tag_size = htonl(size + sizeof(header));
+    buf.append((char *) &tag_size, 4);
+}
+
+FlvTagSerializer::FlvTagSerializer() {
+    //音频同步于视频
+    _stamp[0].syncTo(_stamp[1]);
+}
+
+FlvPacket::Ptr FlvTagSerializer::serialize(List<RtmpPacket::Ptr> &rtmp_list) {
+    if (rtmp_list.empty()) {
+        return nullptr;
+    }
+
+    //预先计算总长度，一次性开辟内存
+    uint32_t total_size = 0;
+    rtmp_list.for_each([&](const RtmpPacket::Ptr &rtmp) {
+        total_size += rtmp->size() + FLV_TAG_OVERHEAD;
+    });
+
+    //头部预留websocket帧头空间
+    string buf;
+    buf.reserve(WS_MAX_HEADER_SIZE + total_size);
+    buf.resize(WS_MAX_HEADER_SIZE);
+    int64_t dts_out = 0;
+    rtmp_list.for_each([&](const RtmpPacket::Ptr &rtmp) {
+        _stamp[rtmp->type_id % 2].revise(rtmp->time_stamp, 0, dts_out, dts_out);
+        appendFlvTag(buf, rtmp->type_id, rtmp->data(), rtmp->size(), dts_out);
+    });
+
+    auto ret = std::make_shared<FlvPacket>(std::move(buf));
+    ret->time_stamp = dts_out;
+    return ret;
+}
+
+}//namespace mediakit
@@ -0,0 +1,68 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_FLVPACKET_H
+#define ZLMEDIAKIT_FLVPACKET_H
+
+#include "Rtmp/Rtmp.h"
+#include "Common/Stamp.h"
+#include "Util/List.h"
+#include "Http/WebSocketSplitter.h"
+using namespace toolkit;
+
+namespace mediakit {
+
+//FLV直播数据包，由一组rtmp包序列化而成的flv tag，可直接写入socket，ws-flv播放器共享其预编码的websocket帧头
+class FlvPacket : public WebSocketPreEncodedBuffer {
+public:
+    using Ptr = std::shared_ptr<FlvPacket>;
+
+    template<typename ...ARGS>
+    FlvPacket(ARGS && ...args) : WebSocketPreEncodedBuffer(std::forward<ARGS>(args)...) {};
+    ~FlvPacket() override = default;
+
+public:
+    uint32_t time_stamp = 0;
+};
+
+/**
+ * 序列化一个flv tag(tag header + tag data + PreviousTagSize)并追加到buf尾部
+ * @param buf 输出缓存
+ * @param type tag类型，MSG_AUDIO/MSG_VIDEO/MSG_DATA
+ * @param data tag data
+ * @param size tag data长度
+ * @param time_stamp tag时间戳
+ */
+void appendFlvTag(string &buf, uint8_t type, const char *data, uint32_t size, uint32_t time_stamp);
+
+/**
+ * rtmp包转flv tag
+ * 每个rtmp源只需要一个实例，所有http-flv播放器共享其输出，
+ * 这样时间戳修整与flv tag序列化只做一次，而不是每个播放器做一次
+ */
+class FlvTagSerializer : public noncopyable {
+public:
+    FlvTagSerializer();
+    ~FlvTagSerializer() = default;
+
+    /**
+     * 把一组rtmp包合并序列化为一个flv包
+     * @param rtmp_list rtmp包列表
+     * @return flv包，列表为空时返回nullptr
+     */
+    FlvPacket::Ptr serialize(List<RtmpPacket::Ptr> &rtmp_list);
+
+private:
+    //时间戳修整器
+    Stamp _stamp[2];
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_FLVPACKET_H
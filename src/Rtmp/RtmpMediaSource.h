@@ -18,6 +18,7 @@
 #include <unordered_map>
 #include "amf.h"
 #include "Rtmp.h"
+#include "FlvPacket.h"
 //#include "RtmpDemuxer.h"
 #include "Common/config.h"
 #include "Common/MediaSource.h"
@@ -47,6 +48,8 @@ public:
     typedef std::shared_ptr<RtmpMediaSource> Ptr;
     typedef std::shared_ptr<List<RtmpPacket::Ptr> > RingDataType;
     typedef RingBuffer<RingDataType> RingType;
+    typedef FlvPacket::Ptr FlvRingDataType;
+    typedef RingBuffer<FlvRingDataType> FlvRingType;
 
     /**
      * 构造函数
@@ -72,11 +75,18 @@ public:
     }
 
     /**
-     * 获取播放器个数
+     * 获取flv tag环形缓冲，http-flv/ws-flv播放器共享
+     */
+    const FlvRingType::Ptr &getFlvRing() const {
+        return _flv_ring;
+    }
+
+    /**
+     * 获取播放器个数(包括rtmp与http-flv播放器)
      * @return
      */
     int readerCount() override {
-        return _ring ? _ring->readerCount() : 0;
+        return (_ring ? _ring->readerCount() : 0) + (_flv_ring ? _flv_ring->readerCount() : 0);
     }
 
     /**
@@ -143,12 +153,15 @@ public:
                 if (!strongSelf) {
                     return;
                 }
-                strongSelf->onReaderChanged(size);
+                //rtmp与flv两个环形缓存的播放器总数
+                strongSelf->onReaderChanged(strongSelf->readerCount());
             };
 
             //GOP默认缓冲512组RTMP包，每组RTMP包时间戳相同(如果开启合并写了，那么每组为合并写时间内的RTMP包),
             //每次遇到关键帧第一个RTMP包，则会清空GOP缓存(因为有新的关键帧了，同样可以实现秒开)
-            _ring = std::make_shared<RingType>(_ring_size,std::move(lam));
+            _ring = std::make_shared<RingType>(_ring_size, lam);
+            //flv tag环形缓存，每组RTMP包序列化为一个flv包，GOP缓存策略与rtmp相同
+            _flv_ring = std::make_shared<FlvRingType>(_ring_size, std::move(lam));
             onReaderChanged(0);
 
             if(_metadata){
@@ -183,6 +196,7 @@ public:
     void clearCache() override{
         PacketCache<RtmpPacket>::clearCache();
         _ring->clearCache();
+        _flv_ring->clearCache();
     }
 
 private:
@@ -193,7 +207,37 @@ private:
     */
     void onFlush(std::shared_ptr<List<RtmpPacket::Ptr> > rtmp_list, bool key_pos) override {
         //如果不存在视频，那么就没有存在GOP缓存的意义，所以is_key一直为true确保一直清空GOP缓存
-        _ring->write(std::move(rtmp_list), _have_video ? key_pos : true);
+        bool is_key = _have_video ? key_pos : true;
+        writeFlv(*rtmp_list, is_key);
+        _ring->write(std::move(rtmp_list), is_key);
+    }
+
+    /**
+     * flv tag只序列化一次，所有http-flv播放器共享；没有http-flv播放器时不序列化
+     */
+    void writeFlv(List<RtmpPacket::Ptr> &rtmp_list, bool is_key) {
+        if (!_flv_ring->readerCount()) {
+            if (_flv_serializer) {
+                //清空已经过时的flv gop缓存，有播放器后重新生成
+                _flv_serializer = nullptr;
+                _flv_ring->clearCache();
+            }
+            return;
+        }
+        if (!_flv_serializer) {
+            //第一个http-flv播放器，先用rtmp的gop缓存补齐flv gop缓存，播放器从关键帧开始收到数据
+            _flv_serializer = std::make_shared<FlvTagSerializer>();
+            _ring->getCache([&](const RingDataType &cached, bool cached_key) {
+                auto flv_pkt = _flv_serializer->serialize(*cached);
+                if (flv_pkt) {
+                    _flv_ring->write(std::move(flv_pkt), cached_key);
+                }
+            });
+        }
+        auto flv_pkt = _flv_serializer->serialize(rtmp_list);
+        if (flv_pkt) {
+            _flv_ring->write(std::move(flv_pkt), is_key);
+        }
     }
 
 private:
@@ -202,6 +246,9 @@ private:
     uint32_t _track_stamps[TrackMax] = {0};
     AMFValue _metadata;
     RingType::Ptr _ring;
+    FlvRingType::Ptr _flv_ring;
+    //有http-flv播放器时才创建
+    std::shared_ptr<FlvTagSerializer> _flv_serializer;
 
     mutable recursive_mutex _mtx;
     unordered_map<int, RtmpPacket::Ptr> _config_frame_map;
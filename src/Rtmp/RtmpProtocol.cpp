@@ -27,6 +27,8 @@ using namespace toolkit;
 namespace mediakit {
 
 RtmpProtocol::RtmpProtocol() {
+    //每个rtmp包有多个chunk头缓存在发送列队中，循环池需要大一些
+    _buffer_pool.setSize(64);
     _next_step_func = [this](const char *data, uint64_t len) {
         return handle_C0C1(data, len);
     };
@@ -550,7 +552,7 @@ void RtmpProtocol::handle_chunk(RtmpPacket& chunk_data) {
 }
 
 BufferRaw::Ptr RtmpProtocol::obtainBuffer() {
-    return std::make_shared<BufferRaw>() ;//_bufferPool.obtain();
+    return _buffer_pool.obtain();
 }
 
 BufferRaw::Ptr RtmpProtocol::obtainBuffer(const void *data, int len) {
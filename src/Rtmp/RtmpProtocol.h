@@ -102,6 +102,8 @@ private:
     function<const char * (const char *data, uint64_t len)> _next_step_func;
     ////////////Chunk////////////
     unordered_map<int, RtmpPacket> _map_chunk_data;
+    //chunk头等小缓存的循环池
+    ResourcePool<BufferRaw> _buffer_pool;
 };
 
 } /* namespace mediakit */
@@ -32,7 +32,8 @@ void RtmpSession::onError(const SockException& err) {
                 << _media_info._streamid
                 << ")断开:" << err.what()
                 << ",time:" << duration << "s"
-                << ",data=" << _total_bytes / 1024.0 / 1024.0 << "MB";
+                << ",data=" << _total_bytes / 1024.0 / 1024.0 << "MB"
+                << ",drop:" << _slow_viewer.getDropCount();
 }
 
 void RtmpSession::onManager() {
@@ -260,9 +261,31 @@ void RtmpSession::sendPlayResponse(const string &err,const RtmpMediaSource::Ptr
 
     //音频同步于视频
     _stamp[0].syncTo(_stamp[1]);
+    _player_src = src;
+
+    weak_ptr<RtmpSession> weak_self = dynamic_pointer_cast<RtmpSession>(shared_from_this());
+    weak_ptr<RtmpMediaSource> weak_src = src;
+    MediaSource::colocateReader(shared_from_this(), src->getRing()->getReaderPoller(), [weak_self, weak_src]() {
+        auto strong_self = weak_self.lock();
+        auto src = weak_src.lock();
+        if (!strong_self) {
+            return;
+        }
+        if (!src) {
+            strong_self->shutdown(SockException(Err_shutdown, "rtmp stream released"));
+            return;
+        }
+        strong_self->attachPlayReader(src);
+    });
+}
+
+void RtmpSession::attachPlayReader(const RtmpMediaSource::Ptr &src) {
+    GET_CONFIG(uint32_t, zero_copy_min_size, General::kZeroCopyMinSize);
+    //播放器发送的都是所有播放器共享的直播数据，适合零拷贝
+    enableZeroCopy(zero_copy_min_size);
     _ring_reader = src->getRing()->attach(getPoller());
     weak_ptr<RtmpSession> weakSelf = dynamic_pointer_cast<RtmpSession>(shared_from_this());
-    _ring_reader->setReadCB([weakSelf](const RtmpMediaSource::RingDataType &pkt) {
+    _ring_reader->setReadKeyCB([weakSelf](const RtmpMediaSource::RingDataType &pkt, bool is_key) {
         auto strongSelf = weakSelf.lock();
         if (!strongSelf) {
             return;
@@ -270,6 +293,9 @@ void RtmpSession::sendPlayResponse(const string &err,const RtmpMediaSource::Ptr
         if(strongSelf->_paused){
             return;
         }
+        if(strongSelf->_slow_viewer.dropPacket(*strongSelf, is_key, pkt->size())){
+            return;
+        }
         int i = 0;
         int size = pkt->size();
         strongSelf->setSendFlushFlag(false);
@@ -287,7 +313,6 @@ void RtmpSession::sendPlayResponse(const string &err,const RtmpMediaSource::Ptr
         }
         strongSelf->shutdown(SockException(Err_shutdown,"rtmp ring buffer detached"));
     });
-    _player_src = src;
     if (src->totalReaderCount() == 1) {
         src->seekTo(0);
     }
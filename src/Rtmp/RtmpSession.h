@@ -22,6 +22,7 @@
 #include "Util/TimeTicker.h"
 #include "Network/TcpSession.h"
 #include "Common/Stamp.h"
+#include "Common/SlowViewerPolicy.h"
 
 using namespace toolkit;
 
@@ -50,6 +51,7 @@ private:
     void doPlay(AMFDecoder &dec);
     void doPlayResponse(const string &err,const std::function<void(bool)> &cb);
     void sendPlayResponse(const string &err,const RtmpMediaSource::Ptr &src);
+    void attachPlayReader(const RtmpMediaSource::Ptr &src);
 
     void onCmd_seek(AMFDecoder &dec);
     void onCmd_pause(AMFDecoder &dec);
@@ -94,6 +96,8 @@ private:
     std::string _tc_url;
     //时间戳修整器
     Stamp _stamp[2];
+    //慢速播放器丢帧策略
+    SlowViewerPolicy _slow_viewer;
     //数据接收超时计时器
     Ticker _ticker;
     MediaInfo _media_info;
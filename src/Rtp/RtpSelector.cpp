@@ -11,6 +11,7 @@ INSTANCE_IMP(RtpSelector);
 void RtpSelector::clear(){
     lock_guard<decltype(_mtx_map)> lck(_mtx_map);
     _map_rtp_process.clear();
+    setSsrcTable_l(std::make_shared<SsrcTable>());
 }
 
 bool RtpSelector::inputRtp(const Socket::Ptr &sock,
@@ -43,7 +44,71 @@ bool RtpSelector::getSSRC(const char *data,int data_len, uint32_t &ssrc){
     return true;
 }
 
+RtpProcess::Ptr RtpSelector::findProcess(std::uint32_t ssrc) {
+    struct Snapshot {
+        const RtpSelector *owner = nullptr;
+        std::uint64_t version = 0;
+        std::shared_ptr<const SsrcTable> table;
+    };
+    static thread_local Snapshot s_snapshot;
+    auto version = _ssrc_table_version.load(std::memory_order_acquire);
+    if (s_snapshot.owner != this || s_snapshot.version != version || !s_snapshot.table) {
+        //RtpProcess有增删，重新获取快照
+        std::lock_guard<decltype(_mtx_map)> lck(_mtx_map);
+        s_snapshot.owner = this;
+        s_snapshot.version = _ssrc_table_version.load(std::memory_order_relaxed);
+        s_snapshot.table = _ssrc_table;
+    }
+    auto it = s_snapshot.table->find(ssrc);
+    return it == s_snapshot.table->end() ? nullptr : it->second.lock();
+}
+
+//key为十进制ssrc的RtpProcess才能被udp收包直接找到
+static bool streamIdToSsrc(const string &key, std::uint32_t &ssrc) {
+    if (key.empty() || key.size() > 10 || key.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    auto val = std::stoull(key);
+    if (val > UINT32_MAX) {
+        return false;
+    }
+    ssrc = (std::uint32_t) val;
+    return true;
+}
+
+void RtpSelector::addSsrc_l(const string &key, const RtpProcess::Ptr &process) {
+    std::uint32_t ssrc;
+    if (streamIdToSsrc(key, ssrc)) {
+        addSsrc_l(ssrc, process);
+    }
+}
+
+void RtpSelector::addSsrc_l(std::uint32_t ssrc, const RtpProcess::Ptr &process) {
+    auto table = std::make_shared<SsrcTable>(*_ssrc_table);
+    (*table)[ssrc] = process;
+    setSsrcTable_l(std::move(table));
+}
+
+void RtpSelector::delSsrc_l(const string &key) {
+    std::uint32_t ssrc;
+    if (!streamIdToSsrc(key, ssrc) || !_ssrc_table->count(ssrc)) {
+        return;
+    }
+    auto table = std::make_shared<SsrcTable>(*_ssrc_table);
+    table->erase(ssrc);
+    setSsrcTable_l(std::move(table));
+}
+
+void RtpSelector::setSsrcTable_l(std::shared_ptr<const SsrcTable> table) {
+    _ssrc_table = std::move(table);
+    _ssrc_table_version.fetch_add(1, std::memory_order_release);
+}
+
 RtpProcess::Ptr RtpSelector::getProcess(const std::uint32_t ssrc) {
+    auto ret = findProcess(ssrc);
+    if (ret) {
+        return ret;
+    }
     const std::string ssrc_str = std::to_string(ssrc);
     std::lock_guard<decltype(_mtx_map)> lck(_mtx_map);
     auto it = _map_rtp_process.find(ssrc_str);
@@ -57,6 +122,7 @@ RtpProcess::Ptr RtpSelector::getProcess(const std::uint32_t ssrc) {
     process->attachEvent();
     _map_rtp_process[ssrc_str] = process;
     _map_ssrc_streamid[stream_id] = ssrc_str;
+    addSsrc_l(ssrc, process->getProcess());
     createTimer();
     
     return process->getProcess();
@@ -84,6 +150,7 @@ RtpProcess::Ptr RtpSelector::getProcess(const std::string& stream_id, bool make_
     RtpProcessHelper::Ptr process = std::make_shared<RtpProcessHelper>(stream_id, shared_from_this());
     process->attachEvent();
     _map_rtp_process[stream_id] = process;
+    addSsrc_l(stream_id, process->getProcess());
     createTimer();
     
     return process->getProcess();
@@ -125,6 +192,7 @@ void RtpSelector::delProcess(const string &stream_id, const RtpProcess *ptr) {
         }
         process = it->second->getProcess();
         _map_rtp_process.erase(it);
+        delSsrc_l(id);
     }
     process->onDetach();
 }
@@ -152,6 +220,7 @@ void RtpSelector::onManager() {
             ErrorL << "RtpProcess timeout:" << stream_id;
             _map_ssrc_streamid.erase(stream_id);
             clear_list.emplace_back(it->second->getProcess());
+            delSsrc_l(it->first);
             it = _map_rtp_process.erase(it);
         }
     }
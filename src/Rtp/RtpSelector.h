@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <mutex>
+#include <atomic>
 #include <unordered_map>
 #include "RtpProcess.h"
 #include "Common/MediaSource.h"
@@ -60,14 +61,26 @@ public:
 
     void for_each_process(const function<void(const string &streamid, const RtpProcess::Ptr _process)> &cb);
 private:
+    //弱引用，线程缓存的快照不延长RtpProcess及其MediaSource的生命周期
+    using SsrcTable = std::unordered_map<std::uint32_t, std::weak_ptr<RtpProcess> >;
+
     void onManager();
     void createTimer();
+    RtpProcess::Ptr findProcess(std::uint32_t ssrc);
+    void addSsrc_l(std::uint32_t ssrc, const RtpProcess::Ptr &process);
+    void addSsrc_l(const string &key, const RtpProcess::Ptr &process);
+    void delSsrc_l(const string &key);
+    void setSsrcTable_l(std::shared_ptr<const SsrcTable> table);
 
 private:
     std::unordered_map<std::string, RtpProcessHelper::Ptr> _map_rtp_process;
     std::unordered_map<std::string, std::string> _map_ssrc_streamid;
     std::recursive_mutex _mtx_map;
     Timer::Ptr _timer;
+    //ssrc至RtpProcess的只读快照，每次增删RtpProcess时拷贝修改并递增版本号
+    //收包线程缓存快照，版本号不变时查找无需加锁
+    std::shared_ptr<const SsrcTable> _ssrc_table = std::make_shared<SsrcTable>();
+    std::atomic<std::uint64_t> _ssrc_table_version{0};
 };
 
 }
@@ -1,5 +1,9 @@
 ﻿#include "RtpServer.h"
 
+#if defined(__linux__)
+#include <linux/filter.h>
+#endif
+
 #include "RtpSelector.h"
 #include "RtpSession.h"
 
@@ -8,10 +12,33 @@ using namespace toolkit;
 
 namespace mediakit{
 
+/**
+ * 让内核按ssrc把rtp包分发到SO_REUSEPORT组内固定的socket(即固定的poller线程)
+ * 这样同一个ssrc的RtpProcess始终在同一线程处理
+ * @param fd 组内任意socket
+ * @param socket_count 组内socket个数
+ */
+static bool attachSsrcSteering(int fd, std::uint32_t socket_count) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    struct sock_filter code[] = {
+        //A = udp负载偏移8字节处的ssrc
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 8),
+        //A = ssrc % socket_count，即组内socket的序号
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, socket_count),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog prog = {sizeof(code) / sizeof(code[0]), code};
+    return 0 == setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+#else
+    return false;
+#endif
+}
+
 RtpServer::RtpServer() {
 }
 
 RtpServer::~RtpServer() {
+    stat_timer_ = nullptr;
     rtp_udp_server_->setOnRead(nullptr);
     rtcp_server_->setOnRead(nullptr);
     for (auto& udp_svr : vec_udp_server_) {
@@ -42,6 +69,17 @@ void RtpServer::start(std::uint32_t rtp_port, std::uint32_t rtcp_port) {
         vec_udp_server_.emplace_back(udp_server);
     });
 
+    if (!vec_udp_server_.empty()) {
+        //socket在SO_REUSEPORT组内的序号即为绑定顺序
+        if (!attachSsrcSteering(vec_udp_server_.front()->rawFD(), vec_udp_server_.size())) {
+            WarnL << "按ssrc分发rtp包失败，将由内核按地址分发:" << get_uv_errmsg(true);
+        }
+        stat_timer_ = std::make_shared<Timer>(60.0f, [this]() {
+            logUdpRecvStat();
+            return true;
+        }, nullptr);
+    }
+
     start_rtcp_server(rtcp_port);
 
     rtp_tcp_server_ = std::make_shared<TcpServer>();
@@ -76,6 +114,23 @@ void RtpServer::start(std::uint32_t rtp_port, std::uint32_t rtcp_port, const std
     rtp_tcp_server_->start<RtpSession>(rtp_port, local_ip_);
 }
 
+void RtpServer::logUdpRecvStat() {
+    uint64_t batches = 0, packets = 0, drops = 0;
+    for (auto &udp_svr : vec_udp_server_) {
+        uint64_t b, p, d;
+        udp_svr->getUdpRecvStat(b, p, d);
+        batches += b;
+        packets += p;
+        drops += d;
+    }
+    if (!batches) {
+        return;
+    }
+    InfoL << "rtp udp port " << rtp_port_ << " 收包:" << packets
+          << ", 平均每批:" << (double) packets / batches
+          << ", 丢包:" << drops;
+}
+
 void RtpServer::setOnDetach(const std::function<void()> &cb){
     if(rtp_process_){
         rtp_process_->setOnDetach(cb);
@@ -28,6 +28,7 @@ public:
     
 private:
     void start_rtcp_server(std::uint32_t port);
+    void logUdpRecvStat();
     
     toolkit::TcpServer::Ptr rtp_tcp_server_;
     toolkit::Socket::Ptr rtp_udp_server_;
@@ -43,6 +44,8 @@ private:
     std::string local_ip_ = "0.0.0.0";
 
     std::vector<toolkit::Socket::Ptr> vec_udp_server_;
+    //定时打印udp收包统计
+    std::shared_ptr<toolkit::Timer> stat_timer_;
 };
 
 }
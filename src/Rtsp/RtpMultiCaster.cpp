@@ -0,0 +1,208 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "RtpMultiCaster.h"
+#include "Network/sockutil.h"
+#include "Util/util.h"
+
+namespace mediakit {
+
+INSTANCE_IMP(MultiCastAddressMaker);
+
+static uint32_t addressToInt(const string &ip) {
+    struct in_addr addr;
+    bzero(&addr, sizeof(addr));
+    addr.s_addr = inet_addr(ip.data());
+    return ntohl(addr.s_addr);
+}
+
+bool MultiCastAddressMaker::isMultiCastAddress(uint32_t addr) {
+    static uint32_t addr_min = addressToInt("224.0.0.0");
+    static uint32_t addr_max = addressToInt("239.255.255.255");
+    return addr >= addr_min && addr <= addr_max;
+}
+
+string MultiCastAddressMaker::toString(uint32_t addr) {
+    struct in_addr in;
+    in.s_addr = htonl(addr);
+    return SockUtil::inet_ntoa(in);
+}
+
+std::shared_ptr<uint32_t> MultiCastAddressMaker::obtain(uint32_t max_try) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    GET_CONFIG(string, addr_min_str, MultiCast::kAddrMin);
+    GET_CONFIG(string, addr_max_str, MultiCast::kAddrMax);
+    uint32_t addr_min = addressToInt(addr_min_str);
+    uint32_t addr_max = addressToInt(addr_max_str);
+
+    if (_addr > addr_max || _addr < addr_min) {
+        _addr = addr_min;
+    }
+    auto ip = _addr++;
+    if (!isMultiCastAddress(ip)) {
+        WarnL << "非法的组播地址范围:" << addr_min_str << "-" << addr_max_str;
+        return nullptr;
+    }
+    if (_used_addr.find(ip) != _used_addr.end()) {
+        //该地址已经分配
+        return max_try ? obtain(max_try - 1) : nullptr;
+    }
+    _used_addr.emplace(ip);
+    return std::shared_ptr<uint32_t>(new uint32_t(ip), [](uint32_t *ptr) {
+        MultiCastAddressMaker::Instance().release(*ptr);
+        delete ptr;
+    });
+}
+
+void MultiCastAddressMaker::release(uint32_t addr) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    _used_addr.erase(addr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+static recursive_mutex s_caster_mtx;
+static unordered_map<string, weak_ptr<RtpMultiCaster> > s_caster_map;
+
+RtpMultiCaster::Ptr RtpMultiCaster::get(const EventPoller::Ptr &poller, const string &local_ip, const RtspMediaSource::Ptr &src) {
+    auto key = local_ip + "/" + src->getVhost() + "/" + src->getApp() + "/" + src->getId();
+    lock_guard<recursive_mutex> lck(s_caster_mtx);
+    auto it = s_caster_map.find(key);
+    if (it != s_caster_map.end()) {
+        auto caster = it->second.lock();
+        if (caster && !caster->isDetached()) {
+            return caster;
+        }
+    }
+    //对象创建失败时抛异常
+    Ptr caster(new RtpMultiCaster(poller, local_ip, src));
+    caster->attach(poller, src);
+    s_caster_map[key] = caster;
+    for (auto it = s_caster_map.begin(); it != s_caster_map.end();) {
+        if (it->second.expired()) {
+            it = s_caster_map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return caster;
+}
+
+RtpMultiCaster::RtpMultiCaster(const EventPoller::Ptr &poller, const string &local_ip, const RtspMediaSource::Ptr &src) {
+    _multicast_ip = MultiCastAddressMaker::Instance().obtain();
+    if (!_multicast_ip) {
+        throw std::runtime_error("获取组播地址失败");
+    }
+    GET_CONFIG(uint32_t, udp_ttl, MultiCast::kUdpTTL);
+    auto group_ip = MultiCastAddressMaker::toString(*_multicast_ip);
+
+    for (auto i = 0; i < 2; ++i) {
+        std::pair<Socket::Ptr, Socket::Ptr> pr = std::make_pair(Socket::createSocket(poller), Socket::createSocket(poller));
+        makeSockPair(pr, local_ip);
+        _rtp_sock[i] = pr.first;
+        _rtcp_sock[i] = pr.second;
+
+        for (auto &sock : {_rtp_sock[i], _rtcp_sock[i]}) {
+            auto fd = sock->rawFD();
+            SockUtil::setMultiTTL(fd, udp_ttl);
+            SockUtil::setMultiIF(fd, local_ip.data());
+
+            struct sockaddr_in peer;
+            bzero(&peer, sizeof(peer));
+            peer.sin_family = AF_INET;
+            //组播目标端口跟本地端口一致
+            peer.sin_port = htons(sock->get_local_port());
+            peer.sin_addr.s_addr = htonl(*_multicast_ip);
+            sock->setSendPeerAddr((struct sockaddr *) &peer);
+        }
+    }
+    InfoL << group_ip << " "
+          << src->getVhost() << " "
+          << src->getApp() << " "
+          << src->getId();
+}
+
+RtpMultiCaster::~RtpMultiCaster() {
+    DebugL << getMultiCasterIP();
+}
+
+void RtpMultiCaster::attach(const EventPoller::Ptr &poller, const RtspMediaSource::Ptr &src) {
+    weak_ptr<RtpMultiCaster> weak_self = shared_from_this();
+    _reader = src->getRing()->attach(poller);
+    _reader->setReadCB([weak_self](const RtspMediaSource::RingDataType &pkt) {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        strong_self->sendRtpPacket(pkt);
+    });
+    _reader->setDetachCB([weak_self]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        strong_self->onDetached();
+    });
+}
+
+bool RtpMultiCaster::isDetached() {
+    lock_guard<recursive_mutex> lck(_mtx);
+    return _detached;
+}
+
+void RtpMultiCaster::setDetachCB(void *listener, const onDetach &cb) {
+    lock_guard<recursive_mutex> lck(_mtx);
+    if (cb) {
+        _detach_map.emplace(listener, cb);
+    } else {
+        _detach_map.erase(listener);
+    }
+}
+
+string RtpMultiCaster::getMultiCasterIP() const {
+    return MultiCastAddressMaker::toString(*_multicast_ip);
+}
+
+uint16_t RtpMultiCaster::getMultiCasterPort(TrackType type) const {
+    return _rtp_sock[type == TrackAudio ? 1 : 0]->get_local_port();
+}
+
+void RtpMultiCaster::sendRtpPacket(const RtspMediaSource::RingDataType &pkt) {
+    int i = 0;
+    int size = pkt->size();
+    pkt->for_each([&](const RtpPacket::Ptr &rtp) {
+        int track_idx = rtp->type == TrackAudio ? 1 : 0;
+        //组播只发送一份，跟播放器个数无关
+        _rtp_sock[track_idx]->send(std::make_shared<BufferRtp>(rtp), nullptr, 0, ++i == size);
+        auto &counter = _rtcp_counter[track_idx];
+        updateRtcpCounter(counter, rtp);
+        auto &ticker = _rtcp_send_ticker[track_idx];
+        if (ticker.elapsedTime() > 5 * 1000) {
+            //每5秒发送一次rtcp sender report
+            ticker.resetTime();
+            _rtcp_sock[track_idx]->send(makeRtcpSR(rtp->ssrc, counter));
+        }
+    });
+}
+
+void RtpMultiCaster::onDetached() {
+    unordered_map<void *, onDetach> detach_map;
+    {
+        lock_guard<recursive_mutex> lck(_mtx);
+        //直播源已注销，此后不再复用该组播发送器
+        _detached = true;
+        detach_map.swap(_detach_map);
+    }
+    for (auto &pr : detach_map) {
+        pr.second();
+    }
+}
+
+}//namespace mediakit
@@ -0,0 +1,106 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_RTPMULTICASTER_H
+#define ZLMEDIAKIT_RTPMULTICASTER_H
+
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "RtspMediaSource.h"
+#include "Network/Socket.h"
+using namespace std;
+using namespace toolkit;
+
+namespace mediakit {
+
+//组播地址分配器，在[multicast.addrMin, multicast.addrMax]范围内轮询分配
+class MultiCastAddressMaker {
+public:
+    ~MultiCastAddressMaker() = default;
+    static MultiCastAddressMaker &Instance();
+    static bool isMultiCastAddress(uint32_t addr);
+    static string toString(uint32_t addr);
+
+    /**
+     * 分配组播地址，返回的对象析构时归还地址
+     * @param max_try 地址冲突时最多重试次数
+     * @return 主机字节序的组播地址，分配失败时返回空
+     */
+    std::shared_ptr<uint32_t> obtain(uint32_t max_try = 10);
+
+private:
+    MultiCastAddressMaker() = default;
+    void release(uint32_t addr);
+
+private:
+    uint32_t _addr = 0;
+    recursive_mutex _mtx;
+    unordered_set<uint32_t> _used_addr;
+};
+
+/**
+ * rtsp组播发送器，每个直播源只有一个环形缓冲读取器，
+ * 每个rtp包只往组播地址发送一次，跟组播播放器个数无关
+ */
+class RtpMultiCaster : public std::enable_shared_from_this<RtpMultiCaster> {
+public:
+    using Ptr = std::shared_ptr<RtpMultiCaster>;
+    using onDetach = function<void()>;
+
+    ~RtpMultiCaster();
+
+    /**
+     * 获取直播源对应的组播发送器，不存在时创建
+     * @param poller 发送线程
+     * @param local_ip 组播发送网卡ip
+     * @param src rtsp直播源
+     */
+    static Ptr get(const EventPoller::Ptr &poller, const string &local_ip, const RtspMediaSource::Ptr &src);
+
+    /**
+     * 设置直播源注销时的回调
+     * @param listener 监听者标识
+     * @param cb 回调，为空时移除监听
+     */
+    void setDetachCB(void *listener, const onDetach &cb);
+
+    /**
+     * 获取组播地址
+     */
+    string getMultiCasterIP() const;
+
+    /**
+     * 获取组播端口，rtcp端口为该端口加1
+     */
+    uint16_t getMultiCasterPort(TrackType type) const;
+
+private:
+    RtpMultiCaster(const EventPoller::Ptr &poller, const string &local_ip, const RtspMediaSource::Ptr &src);
+    void attach(const EventPoller::Ptr &poller, const RtspMediaSource::Ptr &src);
+    void sendRtpPacket(const RtspMediaSource::RingDataType &pkt);
+    void onDetached();
+    bool isDetached();
+
+private:
+    bool _detached = false;
+    std::shared_ptr<uint32_t> _multicast_ip;
+    Socket::Ptr _rtp_sock[2];
+    Socket::Ptr _rtcp_sock[2];
+    RtcpCounter _rtcp_counter[2];
+    Ticker _rtcp_send_ticker[2];
+    RtspMediaSource::RingType::RingReader::Ptr _reader;
+    recursive_mutex _mtx;
+    unordered_map<void *, onDetach> _detach_map;
+};
+
+}//namespace mediakit
+#endif //ZLMEDIAKIT_RTPMULTICASTER_H
@@ -11,7 +11,6 @@
 #ifndef ZLMEDIAKIT_RTPRECEIVER_H
 #define ZLMEDIAKIT_RTPRECEIVER_H
 
-#include <map>
 #include <string>
 #include <memory>
 #include "RtpCodec.h"
@@ -21,6 +20,11 @@ using namespace toolkit;
 
 namespace mediakit {
 
+/**
+ * rtp排序器，以seq为下标的环形缓存
+ * 包按序到达时直接输出，不经过缓存；乱序时缓存至多kMax个包等待缺失的包，
+ * 缓存超过排序长度时跳过缺失的包继续输出
+ */
 template<typename T, typename SEQ = uint16_t, uint32_t kMax = 256, uint32_t kMin = 64>
 class PacketSortor {
 public:
@@ -35,8 +39,14 @@ public:
      * 清空状态
      */
     void clear() {
+        for (auto i = 0u; i < kMax; ++i) {
+            _slots[i].present = false;
+            _slots[i].packet = T();
+        }
+        _started = false;
+        _jump_count = 0;
         _seq_cycle_count = 0;
-        _rtp_sort_cache_map.clear();
+        _size = 0;
         _next_seq_out = 0;
         _max_sort_size = kMin;
     }
@@ -45,7 +55,7 @@ public:
      * 获取排序缓存长度
      */
     int getJitterSize() {
-        return _rtp_sort_cache_map.size();
+        return _size;
     }
 
     /**
@@ -61,101 +71,153 @@ public:
      * @param packet 包负载
      */
     void sortPacket(SEQ seq, T packet) {
-        if (seq < _next_seq_out) {
-            if (_next_seq_out - seq < kMax) {
-                //过滤seq回退包(回环包除外)
+        if (!_started) {
+            _started = true;
+            _next_seq_out = seq;
+        }
+        //考虑回环后seq与下个应输出seq的距离
+        SEQ distance = seq - _next_seq_out;
+        if (distance > kHalfSeq) {
+            //过滤seq回退包以及seq跳变非常大的包(防止个别异常包导致排序窗口来回跳变)
+            if ((SEQ) (_next_seq_out - seq) < kMax || ++_jump_count < kMin) {
                 return;
             }
-        } else if (_next_seq_out && seq - _next_seq_out > (0xFFFF >> 1)) {
-            //过滤seq跳变非常大的包(防止回环时乱序时收到非常大的seq)
+            //连续kMin个包都远离排序窗口，说明推流端重置了seq，重新开始排序
+            reset(seq);
+            distance = 0;
+        } else if (distance >= kMax) {
+            //超出排序窗口，不再等待窗口外缺失的包，向前滑动窗口
+            while (_size && (SEQ) (seq - _next_seq_out) >= kMax) {
+                popNext();
+            }
+            distance = seq - _next_seq_out;
+            if (distance >= kMax) {
+                //缓存已清空，seq跳变(大量丢包)，从该seq重新开始排序
+                if (seq < _next_seq_out) {
+                    //跳变时越过了seq回环
+                    ++_seq_cycle_count;
+                }
+                _next_seq_out = seq;
+                distance = 0;
+            }
+            setSortSize();
+        }
+
+        _jump_count = 0;
+        if (distance == 0 && !_size) {
+            //按序到达，直接输出
+            output(seq, packet);
+            setSortSize();
             return;
         }
 
+        auto &slot = _slots[seq % kMax];
+        if (slot.present) {
+            //重复的包
+            return;
+        }
         //放入排序缓存
-        _rtp_sort_cache_map.emplace(seq, std::move(packet));
+        slot.present = true;
+        slot.packet = std::move(packet);
+        ++_size;
         //尝试输出排序后的包
         tryPopPacket();
     }
 
     void flush(){
         //清空缓存
-        while (!_rtp_sort_cache_map.empty()) {
-            popIterator(_rtp_sort_cache_map.begin());
+        while (_size) {
+            popNext();
         }
     }
 
 private:
-    void popPacket() {
-        auto it = _rtp_sort_cache_map.begin();
-        if (it->first >= _next_seq_out) {
-            //过滤回跳包
-            popIterator(it);
-            return;
+    struct Slot {
+        bool present = false;
+        T packet;
+    };
+
+    static constexpr SEQ kHalfSeq = ((SEQ) ~(SEQ) 0) >> 1;
+
+    void output(SEQ seq, T &packet) {
+        _next_seq_out = seq + 1;
+        if (!_next_seq_out) {
+            //seq回环
+            ++_seq_cycle_count;
         }
+        _cb(seq, packet);
+    }
 
-        if (_next_seq_out - it->first > (0xFFFF >> 1)) {
-            //产生回环了
-            if (_rtp_sort_cache_map.size() < 2 * kMin) {
-                //等足够多的数据后才处理回环, 因为后面还可能出现大的SEQ
+    /**
+     * 输出下一个缓存的包，跳过缺失的包
+     */
+    void popNext() {
+        while (true) {
+            auto &slot = _slots[_next_seq_out % kMax];
+            if (slot.present) {
+                auto packet = std::move(slot.packet);
+                slot.present = false;
+                slot.packet = T();
+                --_size;
+                output(_next_seq_out, packet);
                 return;
             }
-            ++_seq_cycle_count;
-            //找到大的SEQ并清空掉，然后从小的SEQ重新开始排序
-            auto hit = _rtp_sort_cache_map.upper_bound((SEQ) (_next_seq_out - _rtp_sort_cache_map.size()));
-            while (hit != _rtp_sort_cache_map.end()) {
-                //回环前，清空剩余的大的SEQ的数据
-                _cb(hit->first, hit->second);
-                hit = _rtp_sort_cache_map.erase(hit);
+            //丢包，跳过
+            SEQ next = _next_seq_out + 1;
+            if (!next) {
+                ++_seq_cycle_count;
             }
-            //下一个回环的数据
-            popIterator(_rtp_sort_cache_map.begin());
-            return;
+            _next_seq_out = next;
         }
-        //删除回跳的数据包
-        _rtp_sort_cache_map.erase(it);
-    }
-
-    void popIterator(typename map<SEQ, T>::iterator it) {
-        auto seq = it->first;
-        auto data = std::move(it->second);
-        _rtp_sort_cache_map.erase(it);
-        _next_seq_out = seq + 1;
-        _cb(seq, data);
     }
 
     void tryPopPacket() {
         int count = 0;
-        while ((!_rtp_sort_cache_map.empty() && _rtp_sort_cache_map.begin()->first == _next_seq_out)) {
+        while (_size && _slots[_next_seq_out % kMax].present) {
             //找到下个包，直接输出
-            popPacket();
+            popNext();
             ++count;
         }
 
         if (count) {
             setSortSize();
-        } else if (_rtp_sort_cache_map.size() > _max_sort_size) {
-            //排序缓存溢出，不再继续排序
-            popPacket();
+        } else if (_size > _max_sort_size) {
+            //排序缓存溢出，不再等待缺失的包
+            popNext();
+            while (_size && _slots[_next_seq_out % kMax].present) {
+                popNext();
+            }
             setSortSize();
         }
     }
 
+    void reset(SEQ seq) {
+        flush();
+        _next_seq_out = seq;
+    }
+
     void setSortSize() {
-        _max_sort_size = kMin + _rtp_sort_cache_map.size();
+        _max_sort_size = kMin + _size;
         if (_max_sort_size > kMax) {
             _max_sort_size = kMax;
         }
     }
 
 private:
+    //是否收到过包
+    bool _started = false;
     //下次应该输出的SEQ
     SEQ _next_seq_out = 0;
+    //连续远离排序窗口的包个数
+    uint32_t _jump_count = 0;
     //seq回环次数计数
     uint32_t _seq_cycle_count = 0;
     //排序缓存长度
     uint32_t _max_sort_size = kMin;
-    //rtp排序缓存，根据seq排序
-    map<SEQ, T> _rtp_sort_cache_map;
+    //缓存中的包个数
+    uint32_t _size = 0;
+    //rtp排序缓存，以seq % kMax为下标
+    Slot _slots[kMax];
     //回调
     function<void(SEQ seq, T &packet)> _cb;
 };
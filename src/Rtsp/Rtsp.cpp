@@ -414,4 +414,49 @@ string printSSRC(uint32_t ui32Ssrc) {
     return tmp;
 }
 
+void updateRtcpCounter(RtcpCounter &counter, const RtpPacket::Ptr &rtp) {
+    ++counter.pktCnt;
+    counter.octCount += rtp->size() - rtp->offset;
+    //直接保存网络字节序的rtp时间戳
+    memcpy(&counter.timeStamp, rtp->data() + 8, 4);
+    counter.timeStampUs = getCurrentMicrosecond(true);
+}
+
+Buffer::Ptr makeRtcpSR(uint32_t ssrc, const RtcpCounter &counter, int interleaved) {
+    auto buffer = std::make_shared<BufferRaw>();
+    buffer->setCapacity(4 + 28);
+    buffer->setSize(interleaved < 0 ? 28 : 4 + 28);
+    uint8_t *ptr = (uint8_t *) buffer->data();
+    if (interleaved >= 0) {
+        ptr[0] = '$';
+        ptr[1] = interleaved;
+        ptr[2] = 0;
+        ptr[3] = 28;
+        ptr += 4;
+    }
+
+    ptr[0] = 0x80;
+    ptr[1] = 0xC8;//RTCP_SR
+    ptr[2] = 0x00;
+    ptr[3] = 0x06;/* length in words - 1 */
+
+    //ntp时间与rtp时间戳必须是同一时刻，使用发送该rtp包时的系统时间，而不是生成sender report的时间
+    auto stamp_us = counter.timeStampUs ? counter.timeStampUs : getCurrentMicrosecond(true);
+    //ntp时间从1900年开始计算
+    uint32_t msw = htonl((uint32_t) (stamp_us / 1000000 + 0x83AA7E80));
+    uint32_t lsw = htonl((uint32_t) (((stamp_us % 1000000) << 32) / 1000000));
+    uint32_t ssrc_n = htonl(ssrc);
+    uint32_t pkt_cnt = htonl(counter.pktCnt);
+    uint32_t oct_cnt = htonl(counter.octCount);
+
+    memcpy(ptr + 4, &ssrc_n, 4);
+    memcpy(ptr + 8, &msw, 4);
+    memcpy(ptr + 12, &lsw, 4);
+    //rtp时间戳已经是网络字节序
+    memcpy(ptr + 16, &counter.timeStamp, 4);
+    memcpy(ptr + 20, &pkt_cnt, 4);
+    memcpy(ptr + 24, &oct_cnt, 4);
+    return buffer;
+}
+
 }//namespace mediakit
\ No newline at end of file
@@ -101,6 +101,27 @@ public:
     //网络字节序
     uint32_t timeStamp = 0;
     uint32_t lastTimeStamp = 0;
+    //发送timeStamp对应rtp包时的系统时间(微秒)，sender report的ntp时间与之对应
+    uint64_t timeStampUs = 0;
+};
+
+//rtp over udp时去除rtp over tcp的4个字节头，数据不拷贝
+class BufferRtp : public Buffer {
+public:
+    BufferRtp(Buffer::Ptr rtp, uint32_t offset = 4) : _rtp(std::move(rtp)), _offset(offset) {}
+    ~BufferRtp() override = default;
+
+    char *data() const override {
+        return _rtp->data() + _offset;
+    }
+
+    uint32_t size() const override {
+        return _rtp->size() - _offset;
+    }
+
+private:
+    Buffer::Ptr _rtp;
+    uint32_t _offset;
 };
 
 class SdpTrack {
@@ -265,5 +286,18 @@ private:
 void makeSockPair(std::pair<Socket::Ptr, Socket::Ptr> &pair, const string &local_ip);
 string printSSRC(uint32_t ui32Ssrc);
 
+/**
+ * 发送rtp后更新rtcp统计，用于生成sender report
+ */
+void updateRtcpCounter(RtcpCounter &counter, const RtpPacket::Ptr &rtp);
+
+/**
+ * 生成rtcp sender report
+ * @param ssrc 发送端ssrc
+ * @param counter rtcp统计
+ * @param interleaved rtcp over tcp的通道号，小于0时为rtcp over udp
+ */
+Buffer::Ptr makeRtcpSR(uint32_t ssrc, const RtcpCounter &counter, int interleaved = -1);
+
 } //namespace mediakit
 #endif //RTSP_RTSP_H_
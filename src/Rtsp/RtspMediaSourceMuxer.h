@@ -39,18 +39,34 @@ public:
     }
 
     void onReaderChanged(MediaSource &sender, int size) override {
+        GET_CONFIG(bool, rtsp_demand, General::kRtspDemand);
+        _enabled = rtsp_demand ? size : true;
+        if (!size && rtsp_demand) {
+            _clear_cache = true;
+        }
         MediaSourceEventInterceptor::onReaderChanged(sender, size);
     }
 
     void inputFrame(const Frame::Ptr &frame) override {
-        RtspMuxer::inputFrame(frame);
+        GET_CONFIG(bool, rtsp_demand, General::kRtspDemand);
+        if (_clear_cache && rtsp_demand) {
+            _clear_cache = false;
+            _media_src->clearCache();
+        }
+        if (_enabled || !rtsp_demand) {
+            RtspMuxer::inputFrame(frame);
+        }
     }
 
     bool isEnabled() {
-        return true;
+        GET_CONFIG(bool, rtsp_demand, General::kRtspDemand);
+        //缓存尚未清空时，还允许触发inputFrame函数，以便及时清空缓存
+        return rtsp_demand ? (_clear_cache ? true : _enabled) : true;
     }
 
 private:
+    bool _enabled = true;
+    bool _clear_cache = false;
     RtspMediaSource::Ptr _media_src;
 };
 
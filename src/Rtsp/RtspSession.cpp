@@ -21,6 +21,9 @@ RtspSession::RtspSession(const Socket::Ptr &sock) : TcpSession(sock) {
 
 RtspSession::~RtspSession() {
     DebugP(this);
+    if (_multicaster) {
+        _multicaster->setDetachCB(this, nullptr);
+    }
 }
 
 void RtspSession::onError(const SockException &err) {
@@ -29,7 +32,8 @@ void RtspSession::onError(const SockException &err) {
                 << _media_info._app << "/"
                 << _media_info._streamid << ","
                 << _alive_ticker.createdTime() / 1000 << "s,"
-                << _bytes_usage / 1024.0 / 1024.0 << "MB";
+                << _bytes_usage / 1024.0 / 1024.0 << "MB,"
+                << "drop:" << _slow_viewer.getDropCount();
 }
 
 void RtspSession::onManager() {
@@ -47,6 +51,12 @@ void RtspSession::onManager() {
         shutdown(SockException(Err_timeout, "rtsp push session timeouted"));
         return;
     }
+
+    //rtp over udp播放器断开时rtsp tcp连接不一定断开，依赖rtsp心跳或者rtcp receiver report保活
+    if (!_push_src && _rtp_type == Rtsp::RTP_UDP && _alive_ticker.elapsedTime() > keep_alive_sec * 1000) {
+        shutdown(SockException(Err_timeout, "rtp over udp play session timeouted"));
+        return;
+    }
 }
 
 void RtspSession::onRecv(const Buffer::Ptr &buf) {
@@ -271,37 +281,158 @@ void RtspSession::handleReq_Setup(const Parser &parser) {
     }
     trackRef->_inited = true;
 
-    if(parser["Transport"].find("TCP") != string::npos){
-        _rtp_type = Rtsp::RTP_TCP;
+    auto strTransport = parser["Transport"];
+    Rtsp::eRtpType rtp_type;
+    if (strTransport.find("TCP") != string::npos) {
+        rtp_type = Rtsp::RTP_TCP;
+    } else if (strTransport.find("multicast") != string::npos) {
+        rtp_type = Rtsp::RTP_MULTICAST;
     } else {
-        _rtp_type = Rtsp::RTP_UDP;
-        send_UnsupportedTransport(); 
-        return ;
+        rtp_type = Rtsp::RTP_UDP;
+    }
+    if ((_rtp_type != Rtsp::RTP_Invalid && _rtp_type != rtp_type) || (_push_src && rtp_type != Rtsp::RTP_TCP)) {
+        //所有track必须使用相同的传输方式，rtsp推流只支持rtp over tcp
+        send_UnsupportedTransport();
+        return;
+    }
+    _rtp_type = rtp_type;
+
+    switch (_rtp_type) {
+        case Rtsp::RTP_TCP: {
+            RtspSplitter::enableRecvRtp(true);
+            if (_push_src) {
+                //rtsp推流时，interleaved由推流者决定
+                auto key_values = Parser::parseArgs(strTransport, ";", "=");
+                int interleaved_rtp = -1, interleaved_rtcp = -1;
+                if (2 == sscanf(key_values["interleaved"].data(), "%d-%d", &interleaved_rtp, &interleaved_rtcp)) {
+                    trackRef->_interleaved = interleaved_rtp;
+                } else {
+                    throw SockException(Err_shutdown, "can not find interleaved when setup of rtp over tcp");
+                }
+            } else {
+                //rtsp播放时，由于数据共享分发，所以interleaved必须由服务器决定
+                trackRef->_interleaved = 2 * trackRef->_type;
+            }
+            sendRtspResponse("200 OK",
+                             {"Transport", StrPrinter << "RTP/AVP/TCP;unicast;"
+                                                      << "interleaved=" << (int) trackRef->_interleaved << "-"
+                                                      << (int) trackRef->_interleaved + 1 << ";"
+                                                      << "ssrc=" << printSSRC(trackRef->_ssrc),
+                              "x-Transport-Options", "late-tolerance=1.400000",
+                              "x-Dynamic-Rate", "1"
+                             });
+        }
+            break;
+
+        case Rtsp::RTP_UDP: {
+            auto port_str = FindField((strTransport + ";").data(), "client_port=", ";");
+            uint16_t rtp_port = atoi(FindField(port_str.data(), NULL, "-").data());
+            uint16_t rtcp_port = atoi(FindField(port_str.data(), "-", NULL).data());
+            if (!rtp_port) {
+                send_UnsupportedTransport();
+                return;
+            }
+            if (!rtcp_port) {
+                rtcp_port = rtp_port + 1;
+            }
+            try {
+                createUdpSock(trackIdx, rtp_port, rtcp_port);
+            } catch (std::exception &ex) {
+                WarnP(this) << ex.what();
+                send_NotAcceptable();
+                throw SockException(Err_shutdown, ex.what());
+            }
+            sendRtspResponse("200 OK",
+                             {"Transport", StrPrinter << "RTP/AVP;unicast;"
+                                                      << "client_port=" << rtp_port << "-" << rtcp_port << ";"
+                                                      << "server_port=" << _rtp_sock[trackIdx]->get_local_port() << "-"
+                                                      << _rtcp_sock[trackIdx]->get_local_port() << ";"
+                                                      << "ssrc=" << printSSRC(trackRef->_ssrc)
+                             });
+        }
+            break;
+
+        case Rtsp::RTP_MULTICAST: {
+            if (!_multicaster) {
+                auto play_src = _play_src.lock();
+                if (!play_src) {
+                    send_StreamNotFound();
+                    throw SockException(Err_shutdown, "rtsp stream released");
+                }
+                try {
+                    _multicaster = RtpMultiCaster::get(getPoller(), get_local_ip(), play_src);
+                } catch (std::exception &ex) {
+                    WarnP(this) << ex.what();
+                    send_NotAcceptable();
+                    throw SockException(Err_shutdown, ex.what());
+                }
+                weak_ptr<RtspSession> weakSelf = dynamic_pointer_cast<RtspSession>(shared_from_this());
+                _multicaster->setDetachCB(this, [weakSelf]() {
+                    auto strongSelf = weakSelf.lock();
+                    if (!strongSelf) {
+                        return;
+                    }
+                    strongSelf->safeShutdown(SockException(Err_shutdown, "rtsp ring buffer detached"));
+                });
+            }
+            GET_CONFIG(uint32_t, udp_ttl, MultiCast::kUdpTTL);
+            auto port = _multicaster->getMultiCasterPort(trackRef->_type);
+            sendRtspResponse("200 OK",
+                             {"Transport", StrPrinter << "RTP/AVP;multicast;"
+                                                      << "destination=" << _multicaster->getMultiCasterIP() << ";"
+                                                      << "source=" << get_local_ip() << ";"
+                                                      << "port=" << port << "-" << port + 1 << ";"
+                                                      << "ttl=" << udp_ttl << ";"
+                                                      << "ssrc=" << printSSRC(trackRef->_ssrc)
+                             });
+        }
+            break;
+
+        default:
+            break;
     }
+}
 
-    RtspSplitter::enableRecvRtp(true);
+void RtspSession::createUdpSock(int track_idx, uint16_t rtp_port, uint16_t rtcp_port) {
+    auto &rtp_sock = _rtp_sock[track_idx];
+    auto &rtcp_sock = _rtcp_sock[track_idx];
+    if (!rtp_sock || !rtcp_sock) {
+        std::pair<Socket::Ptr, Socket::Ptr> pr = std::make_pair(Socket::createSocket(getPoller()), Socket::createSocket(getPoller()));
+        makeSockPair(pr, get_local_ip());
+        rtp_sock = pr.first;
+        rtcp_sock = pr.second;
+    }
 
-    if(_push_src){
-        //rtsp推流时，interleaved由推流者决定
-        auto key_values =  Parser::parseArgs(parser["Transport"],";","=");
-        int interleaved_rtp = -1 , interleaved_rtcp = -1;
-        if(2 == sscanf(key_values["interleaved"].data(),"%d-%d",&interleaved_rtp,&interleaved_rtcp)){
-            trackRef->_interleaved = interleaved_rtp;
-        }else{
-            throw SockException(Err_shutdown, "can not find interleaved when setup of rtp over tcp");
-        }
-    } else {
-        //rtsp播放时，由于数据共享分发，所以interleaved必须由服务器决定
-        trackRef->_interleaved = 2 * trackRef->_type;
+    //udp目标地址与rtsp tcp连接的对端地址相同，兼容ipv6
+    struct sockaddr_storage peer;
+    socklen_t addr_len = sizeof(peer);
+    bzero(&peer, sizeof(peer));
+    if (getpeername(getSock()->rawFD(), (struct sockaddr *) &peer, &addr_len) != 0) {
+        throw SockException(Err_shutdown, "get rtsp peer address failed");
     }
-    sendRtspResponse("200 OK",
-                     {"Transport", StrPrinter << "RTP/AVP/TCP;unicast;"
-                                              << "interleaved=" << (int) trackRef->_interleaved << "-"
-                                              << (int) trackRef->_interleaved + 1 << ";"
-                                              << "ssrc=" << printSSRC(trackRef->_ssrc),
-                      "x-Transport-Options", "late-tolerance=1.400000",
-                      "x-Dynamic-Rate", "1"
-                     });
+    auto set_port = [&](uint16_t port) {
+        if (peer.ss_family == AF_INET6) {
+            ((struct sockaddr_in6 *) &peer)->sin6_port = htons(port);
+        } else {
+            ((struct sockaddr_in *) &peer)->sin_port = htons(port);
+        }
+    };
+    set_port(rtp_port);
+    rtp_sock->setSendPeerAddr((struct sockaddr *) &peer, addr_len);
+    set_port(rtcp_port);
+    rtcp_sock->setSendPeerAddr((struct sockaddr *) &peer, addr_len);
+
+    weak_ptr<RtspSession> weakSelf = dynamic_pointer_cast<RtspSession>(shared_from_this());
+    auto on_read = [weakSelf](const Buffer::Ptr &buf, struct sockaddr *addr, int addr_len) {
+        auto strongSelf = weakSelf.lock();
+        if (!strongSelf) {
+            return;
+        }
+        //播放器的rtcp receiver report或打洞包，只用于保活
+        strongSelf->_alive_ticker.resetTime();
+    };
+    rtp_sock->setOnRead(on_read);
+    rtcp_sock->setOnRead(on_read);
 }
 
 void RtspSession::handleReq_Play(const Parser &parser) {
@@ -345,26 +476,63 @@ void RtspSession::handleReq_Play(const Parser &parser) {
 
     _enable_send_rtp = true;
 
-    if (!_play_reader) {
-        std::weak_ptr<RtspSession> weakSelf = dynamic_pointer_cast<RtspSession>(shared_from_this());
-        _play_reader = play_src->getRing()->attach(getPoller());
-        _play_reader->setDetachCB([weakSelf]() {
-            auto strongSelf = weakSelf.lock();
-            if (!strongSelf) {
-                return;
-            }
-            strongSelf->shutdown(SockException(Err_shutdown, "rtsp ring buffer detached"));
-        });
-        _play_reader->setReadCB([weakSelf](const RtspMediaSource::RingDataType &pack) {
-            auto strongSelf = weakSelf.lock();
-            if (!strongSelf) {
-                return;
-            }
-            if (strongSelf->_enable_send_rtp) {
-                strongSelf->sendRtpPacket(pack);
-            }
-        });
+    if (_rtp_type == Rtsp::RTP_MULTICAST) {
+        //组播由RtpMultiCaster统一发送，播放器无需读取环形缓冲
+        return;
     }
+
+    if (_play_reader) {
+        return;
+    }
+    if (_rtp_type != Rtsp::RTP_TCP) {
+        //rtp over udp的udp socket绑定在当前poller，不迁移会话
+        attachPlayReader(play_src);
+        return;
+    }
+    std::weak_ptr<RtspSession> weak_self = dynamic_pointer_cast<RtspSession>(shared_from_this());
+    std::weak_ptr<RtspMediaSource> weak_src = play_src;
+    MediaSource::colocateReader(shared_from_this(), play_src->getRing()->getReaderPoller(), [weak_self, weak_src]() {
+        auto strong_self = weak_self.lock();
+        auto play_src = weak_src.lock();
+        if (!strong_self) {
+            return;
+        }
+        if (!play_src) {
+            strong_self->shutdown(SockException(Err_shutdown, "rtsp stream released"));
+            return;
+        }
+        if (!strong_self->_play_reader) {
+            strong_self->attachPlayReader(play_src);
+        }
+    });
+}
+
+void RtspSession::attachPlayReader(const RtspMediaSource::Ptr &play_src) {
+    if (_rtp_type == Rtsp::RTP_TCP) {
+        GET_CONFIG(uint32_t, zero_copy_min_size, General::kZeroCopyMinSize);
+        //rtp over tcp发送的都是所有播放器共享的直播数据，适合零拷贝
+        enableZeroCopy(zero_copy_min_size);
+    }
+    std::weak_ptr<RtspSession> weakSelf = dynamic_pointer_cast<RtspSession>(shared_from_this());
+    _play_reader = play_src->getRing()->attach(getPoller());
+    _play_reader->setDetachCB([weakSelf]() {
+        auto strongSelf = weakSelf.lock();
+        if (!strongSelf) {
+            return;
+        }
+        strongSelf->shutdown(SockException(Err_shutdown, "rtsp ring buffer detached"));
+    });
+    _play_reader->setReadKeyCB([weakSelf](const RtspMediaSource::RingDataType &pack, bool is_key) {
+        auto strongSelf = weakSelf.lock();
+        if (!strongSelf || !strongSelf->_enable_send_rtp) {
+            return;
+        }
+        //rtp over udp不经过tcp发送缓存，无需拥塞丢帧
+        if (strongSelf->_rtp_type == Rtsp::RTP_TCP && strongSelf->_slow_viewer.dropPacket(*strongSelf, is_key, pack->size())) {
+            return;
+        }
+        strongSelf->sendRtpPacket(pack);
+    });
 }
 
 void RtspSession::handleReq_Pause(const Parser &parser) {
@@ -523,13 +691,54 @@ std::shared_ptr<SockInfo> RtspSession::getOriginSock(MediaSource &sender) const
 void RtspSession::sendRtpPacket(const RtspMediaSource::RingDataType &pkt) {
     int i = 0;
     int size = pkt->size();
-    setSendFlushFlag(false);
-    pkt->for_each([&](const RtpPacket::Ptr &rtp) {
-        if (++i == size) {
-            setSendFlushFlag(true);
+    switch (_rtp_type) {
+        case Rtsp::RTP_TCP: {
+            setSendFlushFlag(false);
+            pkt->for_each([&](const RtpPacket::Ptr &rtp) {
+                if (++i == size) {
+                    setSendFlushFlag(true);
+                }
+                send(rtp);
+                sendSenderReport(getTrackIndexByTrackType(rtp->type), rtp);
+            });
         }
-        send(rtp);
-    });
+            break;
+
+        case Rtsp::RTP_UDP: {
+            pkt->for_each([&](const RtpPacket::Ptr &rtp) {
+                int track_idx = getTrackIndexByTrackType(rtp->type);
+                auto &sock = _rtp_sock[track_idx];
+                if (!sock) {
+                    shutdown(SockException(Err_shutdown, "udp sock not opened yet"));
+                    return;
+                }
+                //rtp over udp去除4个字节的头，不拷贝数据
+                _bytes_usage += rtp->size() - 4;
+                sock->send(std::make_shared<BufferRtp>(rtp), nullptr, 0, ++i == size);
+                sendSenderReport(track_idx, rtp);
+            });
+        }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void RtspSession::sendSenderReport(int track_idx, const RtpPacket::Ptr &rtp) {
+    auto &counter = _rtcp_counter[track_idx];
+    updateRtcpCounter(counter, rtp);
+    auto &ticker = _rtcp_send_ticker[track_idx];
+    if (ticker.elapsedTime() < 5 * 1000) {
+        return;
+    }
+    //每5秒发送一次rtcp sender report
+    ticker.resetTime();
+    if (_rtp_type == Rtsp::RTP_TCP) {
+        send(makeRtcpSR(rtp->ssrc, counter, _sdp_track[track_idx]->_interleaved + 1));
+    } else if (_rtcp_sock[track_idx]) {
+        _rtcp_sock[track_idx]->send(makeRtcpSR(rtp->ssrc, counter));
+    }
 }
 
 }
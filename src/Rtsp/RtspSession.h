@@ -13,6 +13,8 @@
 #include "RtpReceiver.h"
 #include "RtspMediaSourceImp.h"
 #include "Common/Stamp.h"
+#include "RtpMultiCaster.h"
+#include "Common/SlowViewerPolicy.h"
 
 namespace mediakit {
 
@@ -71,6 +73,8 @@ private:
     void handleReq_Setup(const Parser &parser);
     //处理play方法，开始或恢复播放
     void handleReq_Play(const Parser &parser);
+    //开始读取直播源环形缓冲
+    void attachPlayReader(const RtspMediaSource::Ptr &play_src);
     //处理pause方法，暂停播放
     void handleReq_Pause(const Parser &parser);
     //处理teardown方法，结束播放
@@ -91,7 +95,11 @@ private:
     int getTrackIndexByTrackType(TrackType type);
     int getTrackIndexByControlSuffix(const string &control_suffix);
     int getTrackIndexByInterleaved(int interleaved);
-    void sendRtpPacket(const RtspMediaSource::RingDataType &pkt);;
+    void sendRtpPacket(const RtspMediaSource::RingDataType &pkt);
+    //发送rtcp sender report
+    void sendSenderReport(int track_idx, const RtpPacket::Ptr &rtp);
+    //创建rtp over udp单播端口
+    void createUdpSock(int track_idx, uint16_t rtp_port, uint16_t rtcp_port);
     bool sendRtspResponse(const string &res_code, const std::initializer_list<string> &header, const string &sdp = "", const char *protocol = "RTSP/1.0");
     bool sendRtspResponse(const string &res_code, const StrCaseMap &header = StrCaseMap(), const string &sdp = "", const char *protocol = "RTSP/1.0");
 private:
@@ -119,6 +127,17 @@ private:
     RtspMediaSource::RingType::RingReader::Ptr _play_reader;
     //sdp里面有效的track,包含音频或视频
     vector<SdpTrack::Ptr> _sdp_track;
+    //rtp over udp单播端口,trackid idx 为数组下标
+    Socket::Ptr _rtp_sock[2];
+    Socket::Ptr _rtcp_sock[2];
+    //rtcp统计,trackid idx 为数组下标
+    RtcpCounter _rtcp_counter[2];
+    //rtcp发送时间,trackid idx 为数组下标
+    Ticker _rtcp_send_ticker[2];
+    //rtsp组播发送器，所有组播播放器共享
+    RtpMultiCaster::Ptr _multicaster;
+    //慢速播放器丢帧策略
+    SlowViewerPolicy _slow_viewer;
 };
 } /* namespace mediakit */
 
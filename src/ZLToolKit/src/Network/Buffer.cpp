@@ -20,7 +20,19 @@ int BufferList::count(){
     return _iovec.size() - _iovec_off;
 }
 
-int BufferList::send_l(int fd, int flags,bool udp) {
+int BufferList::remainSize() const {
+    return _remainSize;
+}
+
+int BufferList::zeroCopy() const {
+    return _zero_copy;
+}
+
+void BufferList::setZeroCopy(bool enable) {
+    _zero_copy = enable;
+}
+
+int BufferList::send_l(int fd, int flags, bool udp, const onSent &cb) {
     int n;
     do {
         struct msghdr msg;
@@ -49,12 +61,15 @@ int BufferList::send_l(int fd, int flags,bool udp) {
         //全部写完了
         _iovec_off = _iovec.size();
         _remainSize = 0;
+        if (cb) {
+            cb(_pkt_list);
+        }
         return n;
     }
 
     if(n > 0){
         //部分发送成功
-        reOffset(n);
+        reOffset(n, cb);
         return n;
     }
 
@@ -62,9 +77,9 @@ int BufferList::send_l(int fd, int flags,bool udp) {
     return n;
 }
 
-int BufferList::send(int fd,int flags,bool udp) {
+int BufferList::send(int fd, int flags, bool udp, const onSent &cb) {
     auto remainSize = _remainSize;
-    while (_remainSize && send_l(fd,flags,udp) != -1);
+    while (_remainSize && send_l(fd, flags, udp, cb) != -1);
 
     int sent = remainSize - _remainSize;
     if(sent > 0){
@@ -75,10 +90,11 @@ int BufferList::send(int fd,int flags,bool udp) {
     return -1;
 }
 
-void BufferList::reOffset(int n) {
+void BufferList::reOffset(int n, const onSent &cb) {
     _remainSize -= n;
     int offset = 0;
     int last_off = _iovec_off;
+    bool partial = false;
     for(int i = _iovec_off ; i != _iovec.size() ; ++i ){
         auto &ref = _iovec[i];
         offset += ref.iov_len;
@@ -91,14 +107,27 @@ void BufferList::reOffset(int n) {
         _iovec_off = i;
         if(remain == 0){
             _iovec_off += 1;
+        } else {
+            partial = true;
         }
         break;
     }
 
     //删除已经发送的数据，节省内存
+    List<Buffer::Ptr> sent;
     for (int i = last_off ; i < _iovec_off ; ++i){
+        if (cb) {
+            sent.emplace_back(std::move(_pkt_list.front()));
+        }
         _pkt_list.pop_front();
     }
+    if (cb) {
+        if (partial) {
+            //部分发送的Buffer也被本次零拷贝发送引用，同样需要保持到内核完成通知
+            sent.emplace_back(_pkt_list.front());
+        }
+        cb(sent);
+    }
 }
 
 BufferList::BufferList(List<Buffer::Ptr> &list) : _iovec(list.size()) {
@@ -427,18 +427,26 @@ private:
 class BufferList : public noncopyable {
 public:
     typedef std::shared_ptr<BufferList> Ptr;
+    //每次sendmsg成功后回调本次发送完毕的Buffer，用于零拷贝发送时保持其引用
+    typedef function<void(List<Buffer::Ptr> &sent)> onSent;
     BufferList(List<Buffer::Ptr> &list);
     ~BufferList(){}
     bool empty();
     int count();
-    int send(int fd,int flags,bool udp);
+    //剩余未发送的字节数
+    int remainSize() const;
+    //是否使用零拷贝发送，-1为尚未确定；首次发送前确定，此后整个列表保持不变
+    int zeroCopy() const;
+    void setZeroCopy(bool enable);
+    int send(int fd, int flags, bool udp, const onSent &cb = nullptr);
 private:
-    void reOffset(int n);
-    int send_l(int fd,int flags,bool udp);
+    void reOffset(int n, const onSent &cb);
+    int send_l(int fd, int flags, bool udp, const onSent &cb);
 private:
     vector<struct iovec> _iovec;
     int _iovec_off = 0;
     int _remainSize = 0;
+    int _zero_copy = -1;
     List<Buffer::Ptr> _pkt_list;
 };
 
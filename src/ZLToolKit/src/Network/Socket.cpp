@@ -21,15 +21,73 @@ using namespace std;
 
 #define LOCK_GUARD(mtx) lock_guard<decltype(mtx)> lck(mtx)
 
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define ENABLE_ZERO_COPY 1
+//连续多少次回退为拷贝发送后关闭零拷贝
+#define ZERO_COPY_MAX_COPIED 64
+#endif
+
+#if defined(__linux__)
+//udp批量收包，每次recvmmsg最多收取的包个数
+#define UDP_RECV_BATCH_SIZE 16
+//udp单个数据包最大长度
+#define UDP_MAX_PACKET_SIZE (64 * 1024)
+#endif
+
 namespace toolkit {
 
+#if defined(__linux__)
+//recvmmsg所需的缓存，同一poller线程下所有udp socket共享
+class UdpRecvBatch {
+public:
+    UdpRecvBatch() {
+        memset(_msgs, 0, sizeof(_msgs));
+        for (int i = 0; i < UDP_RECV_BATCH_SIZE; ++i) {
+            //预留一个字节存放\0结尾符
+            _buffers[i] = std::make_shared<BufferRaw>(1 + UDP_MAX_PACKET_SIZE);
+            _iovs[i].iov_base = _buffers[i]->data();
+            _iovs[i].iov_len = UDP_MAX_PACKET_SIZE;
+            _msgs[i].msg_hdr.msg_iov = &_iovs[i];
+            _msgs[i].msg_hdr.msg_iovlen = 1;
+            _msgs[i].msg_hdr.msg_name = &_addrs[i];
+            _msgs[i].msg_hdr.msg_control = _controls[i];
+        }
+    }
+
+    static UdpRecvBatch &Instance() {
+        static thread_local UdpRecvBatch s_batch;
+        return s_batch;
+    }
+
+    //recvmmsg会修改这些字段，每次调用前需要重置
+    void reset() {
+        for (int i = 0; i < UDP_RECV_BATCH_SIZE; ++i) {
+            _msgs[i].msg_hdr.msg_namelen = sizeof(_addrs[i]);
+            _msgs[i].msg_hdr.msg_controllen = sizeof(_controls[i]);
+            _msgs[i].msg_hdr.msg_flags = 0;
+        }
+    }
+
+public:
+    struct mmsghdr _msgs[UDP_RECV_BATCH_SIZE];
+    struct iovec _iovs[UDP_RECV_BATCH_SIZE];
+    struct sockaddr_storage _addrs[UDP_RECV_BATCH_SIZE];
+    char _controls[UDP_RECV_BATCH_SIZE][CMSG_SPACE(sizeof(uint32_t))];
+    BufferRaw::Ptr _buffers[UDP_RECV_BATCH_SIZE];
+};
+#endif //defined(__linux__)
+
 Socket::Ptr Socket::createSocket(const EventPoller::Ptr &poller, bool enable_mutex){
     return Socket::Ptr(new Socket(poller, enable_mutex));
 }
 
 Socket::Socket(const EventPoller::Ptr &poller, bool enable_mutex) :
         _mtx_sock_fd(enable_mutex), _mtx_send_buf_waiting(enable_mutex),
-        _mtx_send_buf_sending(enable_mutex), _mtx_event(enable_mutex){
+        _mtx_send_buf_sending(enable_mutex), _mtx_event(enable_mutex), _mtx_zero_copy(enable_mutex){
 
     _poller = poller;
     if (!_poller) {
@@ -135,7 +193,7 @@ void Socket::connect(const string &url, uint16_t port, onErrCB con_cb_in, float
         weak_ptr<SockFD> weak_sock_fd = sock_fd;
 
         //监听该socket是否可写，可写表明已经连接服务器成功
-        int result = strong_self->_poller->addEvent(sock, Event_Write, [weak_self, weak_sock_fd, con_cb](int event) {
+        int result = strong_self->getPoller()->addEvent(sock, Event_Write, [weak_self, weak_sock_fd, con_cb](int event) {
             auto strong_sock_fd = weak_sock_fd.lock();
             auto strong_self = weak_self.lock();
             if (strong_sock_fd && strong_self) {
@@ -154,7 +212,7 @@ void Socket::connect(const string &url, uint16_t port, onErrCB con_cb_in, float
         strong_self->_sock_fd = sock_fd;
     });
 
-    auto poller = _poller;
+    auto poller = getPoller();
     weak_ptr<function<void(int)> > weak_task = async_con_cb;
 
     WorkThreadPool::Instance().getExecutor()->async([url, port, local_ip, local_port, weak_task, poller]() {
@@ -174,7 +232,7 @@ void Socket::connect(const string &url, uint16_t port, onErrCB con_cb_in, float
     _con_timer = std::make_shared<Timer>(timeout_sec, [weak_self, con_cb]() {
         con_cb(SockException(Err_timeout, uv_strerror(UV_ETIMEDOUT)));
         return false;
-    }, _poller);
+    }, getPoller());
 
     _async_con_cb = async_con_cb;
 }
@@ -208,7 +266,7 @@ void Socket::onConnected(const SockFD::Ptr &sock, const onErrCB &cb) {
     }
 
     //先删除之前的可写事件监听
-    _poller->delEvent(sock->rawFd());
+    getPoller()->delEvent(sock->rawFd());
     if (!attachEvent(sock, false)) {
         //连接失败
         cb(SockException(Err_other, "add event to poller failed when connected"));
@@ -224,8 +282,8 @@ bool Socket::attachEvent(const SockFD::Ptr &sock, bool is_udp) {
     weak_ptr<Socket> weak_self = shared_from_this();
     weak_ptr<SockFD> weak_sock = sock;
     _enable_recv = true;
-    _read_buffer = _poller->getSharedBuffer();
-    int result = _poller->addEvent(sock->rawFd(),
+    _read_buffer = getPoller()->getSharedBuffer();
+    int result = getPoller()->addEvent(sock->rawFd(),
                                    Event_Read | Event_Error | Event_Write,
                                    [weak_self,weak_sock,is_udp](int event) {
         auto strong_self = weak_self.lock();
@@ -241,7 +299,10 @@ bool Socket::attachEvent(const SockFD::Ptr &sock, bool is_udp) {
             strong_self->onWriteAble(strong_sock);
         }
         if (event & Event_Error) {
-            strong_self->onError(strong_sock);
+            //零拷贝发送完成通知也通过错误列队返回
+            if (!strong_self->onZeroCopyNotify(strong_sock)) {
+                strong_self->onError(strong_sock);
+            }
         }
     });
 
@@ -249,6 +310,11 @@ bool Socket::attachEvent(const SockFD::Ptr &sock, bool is_udp) {
 }
 
 int Socket::onRead(const SockFD::Ptr &sock, bool is_udp) noexcept {
+#if defined(__linux__)
+    if (is_udp) {
+        return onReadUdp(sock);
+    }
+#endif
     int ret = 0, nread = 0, sock_fd = sock->rawFd();
 
     auto data = _read_buffer->data();
@@ -294,6 +360,71 @@ int Socket::onRead(const SockFD::Ptr &sock, bool is_udp) noexcept {
     return 0;
 }
 
+int Socket::onReadUdp(const SockFD::Ptr &sock) noexcept {
+#if defined(__linux__)
+    int ret = 0, count = 0, sock_fd = sock->rawFd();
+    //onRead只在poller线程触发，所以可以使用线程局部的收包缓存
+    auto &batch = UdpRecvBatch::Instance();
+    while (_enable_recv) {
+        batch.reset();
+        do {
+            count = recvmmsg(sock_fd, batch._msgs, UDP_RECV_BATCH_SIZE, 0, nullptr);
+        } while (-1 == count && UV_EINTR == get_uv_error(true));
+
+        if (count == -1) {
+            if (get_uv_error(true) != UV_EAGAIN) {
+                onError(sock);
+            }
+            return ret;
+        }
+        if (count == 0) {
+            return ret;
+        }
+        _udp_recv_batches += 1;
+        _udp_recv_packets += count;
+
+        LOCK_GUARD(_mtx_event);
+        for (int i = 0; i < count; ++i) {
+            auto &hdr = batch._msgs[i].msg_hdr;
+            for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t ovfl;
+                    memcpy(&ovfl, CMSG_DATA(cmsg), sizeof(ovfl));
+                    _udp_recv_drops += ovfl - _udp_last_ovfl;
+                    _udp_last_ovfl = ovfl;
+                }
+            }
+            auto nread = batch._msgs[i].msg_len;
+            if (nread == 0) {
+                continue;
+            }
+            if (hdr.msg_flags & MSG_TRUNC) {
+                WarnL << "udp数据包过大被截断";
+            }
+            ret += nread;
+            auto &buffer = batch._buffers[i];
+            buffer->data()[nread] = '\0';
+            buffer->setSize(nread);
+            try {
+                //此处捕获异常，目的是防止数据未读尽，epoll边沿触发失效的问题
+                _on_read(buffer, (struct sockaddr *) hdr.msg_name, hdr.msg_namelen);
+            } catch (std::exception &ex) {
+                ErrorL << "触发socket on_read事件时,捕获到异常:" << ex.what();
+            }
+        }
+    }
+    return ret;
+#else
+    return 0;
+#endif
+}
+
+void Socket::getUdpRecvStat(uint64_t &batches, uint64_t &packets, uint64_t &drops) const {
+    batches = _udp_recv_batches;
+    packets = _udp_recv_packets;
+    drops = _udp_recv_drops;
+}
+
 void Socket::onError(const SockFD::Ptr &sock) {
     emitErr(getSockErr(sock));
 }
@@ -310,7 +441,7 @@ bool Socket::emitErr(const SockException& err) noexcept{
     closeSock();
 
     weak_ptr<Socket> weak_self = shared_from_this();
-    _poller->async([weak_self, err]() {
+    getPoller()->async([weak_self, err]() {
         auto strong_self = weak_self.lock();
         if (!strong_self) {
             return;
@@ -364,6 +495,7 @@ int Socket::send(Buffer::Ptr buf, struct sockaddr *addr, socklen_t addr_len, boo
         LOCK_GUARD(_mtx_send_buf_waiting);
         _send_buf_waiting.emplace_back(sock->type() == SockNum::Sock_UDP ? std::make_shared<BufferSock>(std::move(buf), addr, addr_len) : buf);
     }
+    _send_buf_bytes += size;
 
     if(try_flush){
         if (_sendable) {
@@ -397,8 +529,29 @@ void Socket::closeSock() {
     _con_timer = nullptr;
     _async_con_cb = nullptr;
 
-    LOCK_GUARD(_mtx_sock_fd);
-    _sock_fd  = nullptr;
+    {
+        LOCK_GUARD(_mtx_sock_fd);
+        _sock_fd = nullptr;
+    }
+
+    //连接已关闭，未发送的数据不再发送，同时扣除其计入的待发送字节数
+    //(poller线程正在发送的数据由flushData自行扣除，所以不能直接清零)
+    uint64_t dropped = 0;
+    {
+        LOCK_GUARD(_mtx_send_buf_waiting);
+        _send_buf_waiting.for_each([&](Buffer::Ptr &buf) {
+            dropped += buf->size();
+        });
+        _send_buf_waiting.clear();
+    }
+    {
+        LOCK_GUARD(_mtx_send_buf_sending);
+        _send_buf_sending.for_each([&](BufferList::Ptr &buf) {
+            dropped += buf->remainSize();
+        });
+        _send_buf_sending.clear();
+    }
+    _send_buf_bytes -= dropped;
 }
 
 int Socket::getSendBufferCount(){
@@ -421,12 +574,129 @@ uint64_t Socket::elapsedTimeAfterFlushed(){
     return _send_flush_ticker.elapsedTime();
 }
 
+uint64_t Socket::getSendBufferBytes() const{
+    return _send_buf_bytes.load();
+}
+
+bool Socket::enableZeroCopy(uint32_t min_size) {
+#if defined(ENABLE_ZERO_COPY)
+    if (min_size) {
+        LOCK_GUARD(_mtx_sock_fd);
+        if (!_sock_fd || _sock_fd->type() != SockNum::Sock_TCP) {
+            return false;
+        }
+        int on = 1;
+        if (setsockopt(_sock_fd->rawFd(), SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == -1) {
+            WarnL << "设置SO_ZEROCOPY失败:" << get_uv_errmsg(true);
+            return false;
+        }
+    }
+    _zero_copy_min_size = min_size;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Socket::getZeroCopyStat(uint64_t &hits, uint64_t &copied) const {
+    hits = _zero_copy_hits.load();
+    copied = _zero_copy_copied.load();
+}
+
+void Socket::onZeroCopySent(List<Buffer::Ptr> &sent) {
+    //每次零拷贝sendmsg成功都对应一个内核通知序号，即使本次没有Buffer发送完毕
+    LOCK_GUARD(_mtx_zero_copy);
+    _zero_copy_pending.emplace_back();
+    _zero_copy_pending.back().buffers.swap(sent);
+}
+
+bool Socket::onZeroCopyNotify(const SockFD::Ptr &sock) {
+#if defined(ENABLE_ZERO_COPY)
+    {
+        LOCK_GUARD(_mtx_zero_copy);
+        if (_zero_copy_pending.empty()) {
+            return false;
+        }
+    }
+    int count = 0;
+    char control[128];
+    while (true) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        int ret;
+        do {
+            ret = recvmsg(sock->rawFd(), &msg, MSG_ERRQUEUE);
+        } while (-1 == ret && UV_EINTR == get_uv_error(true));
+        if (ret == -1) {
+            //错误列队已经读完
+            break;
+        }
+        for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            auto err = (struct sock_extended_err *) CMSG_DATA(cmsg);
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            //[ee_info, ee_data]范围内的sendmsg已经发送完毕
+            onZeroCopyComplete(err->ee_info, err->ee_data, err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+            ++count;
+        }
+    }
+    if (!count) {
+        return false;
+    }
+    auto err = getSockErr(sock, false);
+    if (err) {
+        emitErr(err);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Socket::onZeroCopyComplete(uint32_t lo, uint32_t hi, bool copied) {
+    uint32_t count = hi - lo + 1;
+    if (copied) {
+        _zero_copy_copied += count;
+#if defined(ENABLE_ZERO_COPY)
+        _zero_copy_copied_continuous += count;
+        if (_zero_copy_copied_continuous >= ZERO_COPY_MAX_COPIED && _zero_copy_min_size) {
+            //内核无法零拷贝(例如网卡不支持scatter-gather或者本机回环)，额外开销得不偿失
+            _zero_copy_min_size = 0;
+            WarnL << "内核持续回退为拷贝发送，关闭零拷贝:" << get_peer_ip() << ":" << get_peer_port();
+        }
+#endif
+    } else {
+        _zero_copy_hits += count;
+        _zero_copy_copied_continuous = 0;
+    }
+
+    LOCK_GUARD(_mtx_zero_copy);
+    //通知序号会回绕，按与队首序号的差值定位
+    auto begin = (int32_t) (lo - _zero_copy_head_id);
+    auto end = (int32_t) (hi - _zero_copy_head_id);
+    for (auto i = std::max(begin, 0); i <= end && i < (int32_t) _zero_copy_pending.size(); ++i) {
+        _zero_copy_pending[i].done = true;
+    }
+    //通知可能乱序，只释放队首连续完成的部分
+    while (!_zero_copy_pending.empty() && _zero_copy_pending.front().done) {
+        _zero_copy_pending.pop_front();
+        ++_zero_copy_head_id;
+    }
+}
+
 bool Socket::listen(const SockFD::Ptr &sock){
     closeSock();
     weak_ptr<SockFD> weak_sock = sock;
     weak_ptr<Socket> weak_self = shared_from_this();
     _enable_recv = true;
-    int result = _poller->addEvent(sock->rawFd(), Event_Read | Event_Error, [weak_self, weak_sock](int event) {
+    int result = getPoller()->addEvent(sock->rawFd(), Event_Read | Event_Error, [weak_self, weak_sock](int event) {
         auto strong_self = weak_self.lock();
         auto strong_sock = weak_sock.lock();
         if (!strong_self || !strong_sock) {
@@ -500,7 +770,7 @@ int Socket::onAccept(const SockFD::Ptr &sock, int event) noexcept {
                 LOCK_GUARD(_mtx_event);
                 try {
                     //此处捕获异常，目的是防止socket未accept尽，epoll边沿触发失效的问题
-                    peer_sock = _on_before_accept(_poller);
+                    peer_sock = _on_before_accept(getPoller());
                 } catch (std::exception &ex) {
                     ErrorL << "触发socket before accept事件时,捕获到异常:" << ex.what();
                     close(fd);
@@ -510,7 +780,7 @@ int Socket::onAccept(const SockFD::Ptr &sock, int event) noexcept {
 
             if (!peer_sock) {
                 //此处是默认构造行为，也就是子Socket共用父Socket的poll线程并且关闭互斥锁
-                peer_sock = Socket::createSocket(_poller, false);
+                peer_sock = Socket::createSocket(getPoller(), false);
             }
 
             //设置好fd,以备在onAccept事件中可以正常访问该fd
@@ -625,8 +895,24 @@ bool Socket::flushData(const SockFD::Ptr &sock, bool poller_thread) {
     bool is_udp = sock->type() == SockNum::Sock_UDP;
     while (!send_buf_sending_tmp.empty()) {
         auto &packet = send_buf_sending_tmp.front();
-        int n = packet->send(fd, _sock_flags, is_udp);
+        int flags = _sock_flags;
+        BufferList::onSent on_sent;
+#if defined(ENABLE_ZERO_COPY)
+        if (packet->zeroCopy() == -1) {
+            //部分零拷贝发送的Buffer在后续发送中仍被内核引用，所以整个列表统一决定是否零拷贝
+            auto zero_copy_min_size = _zero_copy_min_size.load();
+            packet->setZeroCopy(zero_copy_min_size && !is_udp && packet->remainSize() >= (int) zero_copy_min_size);
+        }
+        if (packet->zeroCopy() == 1) {
+            flags |= MSG_ZEROCOPY;
+            on_sent = [this](List<Buffer::Ptr> &sent) {
+                onZeroCopySent(sent);
+            };
+        }
+#endif
+        int n = packet->send(fd, flags, is_udp, on_sent);
         if (n > 0) {
+            _send_buf_bytes -= n;
             //全部或部分发送成功
             if (packet->empty()) {
                 //全部发送成功
@@ -693,18 +979,51 @@ void Socket::onWriteAble(const SockFD::Ptr &sock) {
     }
 }
 
+void Socket::moveToPoller(const EventPoller::Ptr &poller, const function<void(bool success)> &cb) {
+    assert(getPoller()->isCurrentThread());
+    //停止onRead中的收数据循环，防止原poller线程与目标poller线程同时读socket
+    _enable_recv = false;
+    weak_ptr<Socket> weak_self = shared_from_this();
+    //等待原poller线程本轮事件处理完毕后再切换poller
+    getPoller()->async([weak_self, poller, cb]() {
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        SockFD::Ptr new_sock;
+        {
+            LOCK_GUARD(strong_self->_mtx_sock_fd);
+            if (strong_self->_sock_fd) {
+                //新旧SockFD共享同一个fd，旧的SockFD析构时会从原poller中移除该fd的事件监听
+                new_sock = std::make_shared<SockFD>(*(strong_self->_sock_fd), poller);
+                strong_self->_sock_fd = new_sock;
+            }
+        }
+        //其他线程可能同时通过getPoller()读取
+        std::atomic_store(&strong_self->_poller, poller);
+        poller->async([weak_self, new_sock, cb]() {
+            auto strong_self = weak_self.lock();
+            if (!strong_self) {
+                return;
+            }
+            //同时监听可写事件，以便发送迁移前未发送完毕的数据
+            cb(new_sock && strong_self->attachEvent(new_sock, false));
+        }, false);
+    }, false);
+}
+
 void Socket::startWriteAbleEvent(const SockFD::Ptr &sock) {
     //开始监听socket可写事件
     _sendable = false;
     int flag = _enable_recv ? Event_Read : 0;
-    _poller->modifyEvent(sock->rawFd(), flag | Event_Error | Event_Write);
+    getPoller()->modifyEvent(sock->rawFd(), flag | Event_Error | Event_Write);
 }
 
 void Socket::stopWriteAbleEvent(const SockFD::Ptr &sock) {
     //停止监听socket可写事件
     _sendable = true;
     int flag = _enable_recv ? Event_Read : 0;
-    _poller->modifyEvent(sock->rawFd(), flag | Event_Error);
+    getPoller()->modifyEvent(sock->rawFd(), flag | Event_Error);
 }
 
 void Socket::enableRecv(bool enabled) {
@@ -715,11 +1034,11 @@ void Socket::enableRecv(bool enabled) {
     int read_flag = _enable_recv ? Event_Read : 0;
     //可写时，不监听可写事件
     int send_flag = _sendable ? 0 : Event_Write;
-    _poller->modifyEvent(rawFD(), read_flag | send_flag | Event_Error);
+    getPoller()->modifyEvent(rawFD(), read_flag | send_flag | Event_Error);
 }
 
 SockFD::Ptr Socket::makeSock(int sock,SockNum::SockType type){
-    return std::make_shared<SockFD>(sock, type, _poller);
+    return std::make_shared<SockFD>(sock, type, getPoller());
 }
 
 int Socket::rawFD() const{
@@ -734,6 +1053,10 @@ void Socket::setSendTimeOutSecond(uint32_t second){
     _max_send_buffer_ms = second * 1000;
 }
 
+uint32_t Socket::getSendTimeOutMS() const{
+    return _max_send_buffer_ms;
+}
+
 BufferRaw::Ptr Socket::obtainBuffer() {
     return std::make_shared<BufferRaw>();//_bufferPool.obtain();
 }
@@ -742,8 +1065,9 @@ bool Socket::isSocketBusy() const{
     return !_sendable.load();
 }
 
-const EventPoller::Ptr &Socket::getPoller() const{
-    return _poller;
+EventPoller::Ptr Socket::getPoller() const{
+    //moveToPoller时会被修改
+    return std::atomic_load(&_poller);
 }
 
 bool Socket::cloneFromListenSocket(const Socket &other){
@@ -754,7 +1078,7 @@ bool Socket::cloneFromListenSocket(const Socket &other){
             WarnL << "sockfd of src socket is null!";
             return false;
         }
-        sock = std::make_shared<SockFD>(*(other._sock_fd), _poller);
+        sock = std::make_shared<SockFD>(*(other._sock_fd), getPoller());
     }
     return listen(sock);
 }
@@ -814,7 +1138,8 @@ SocketHelper::SocketHelper(const Socket::Ptr &sock) {
 SocketHelper::~SocketHelper() {}
 
 void SocketHelper::setPoller(const EventPoller::Ptr &poller){
-    _poller = poller;
+    //会话迁移时修改，其他线程可能同时通过getPoller()读取
+    std::atomic_store(&_poller, poller);
 }
 
 void SocketHelper::setSock(const Socket::Ptr &sock) {
@@ -824,13 +1149,14 @@ void SocketHelper::setSock(const Socket::Ptr &sock) {
     _local_ip.clear();
     _sock = sock;
     if (_sock) {
-        _poller = _sock->getPoller();
+        setPoller(_sock->getPoller());
     }
 }
 
-const EventPoller::Ptr& SocketHelper::getPoller() const {
-    assert(_poller);
-    return _poller;
+EventPoller::Ptr SocketHelper::getPoller() const {
+    auto poller = std::atomic_load(&_poller);
+    assert(poller);
+    return poller;
 }
 
 const Socket::Ptr& SocketHelper::getSock() const{
@@ -898,12 +1224,35 @@ bool SocketHelper::isSocketBusy() const {
     return _sock->isSocketBusy();
 }
 
+uint64_t SocketHelper::getSendBufferBytes() const {
+    return _sock ? _sock->getSendBufferBytes() : 0;
+}
+
+uint64_t SocketHelper::elapsedTimeAfterFlushed() const {
+    return _sock ? _sock->elapsedTimeAfterFlushed() : 0;
+}
+
+uint32_t SocketHelper::getSendTimeOutMS() const {
+    return _sock ? _sock->getSendTimeOutMS() : 0;
+}
+
+bool SocketHelper::enableZeroCopy(uint32_t min_size) {
+    return _sock ? _sock->enableZeroCopy(min_size) : false;
+}
+
+void SocketHelper::getZeroCopyStat(uint64_t &hits, uint64_t &copied) const {
+    hits = copied = 0;
+    if (_sock) {
+        _sock->getZeroCopyStat(hits, copied);
+    }
+}
+
 Task::Ptr SocketHelper::async(TaskIn task, bool may_sync) {
-    return _poller->async(std::move(task), may_sync);
+    return getPoller()->async(std::move(task), may_sync);
 }
 
 Task::Ptr SocketHelper::async_first(TaskIn task, bool may_sync) {
-    return _poller->async_first(std::move(task), may_sync);
+    return getPoller()->async_first(std::move(task), may_sync);
 }
 
 void SocketHelper::setSendFlushFlag(bool try_flush) {
@@ -928,7 +1277,7 @@ void SocketHelper::setOnCreateSocket(Socket::onCreateSocket cb){
 }
 
 Socket::Ptr SocketHelper::createSocket(){
-    return _on_create_socket(_poller);
+    return _on_create_socket(getPoller());
 }
 
 }  // namespace toolkit
@@ -372,6 +372,11 @@ public:
      */
     virtual void setSendTimeOutSecond(uint32_t second);
 
+    /**
+     * 获取发送超时主动断开时间，单位毫秒
+     */
+    uint32_t getSendTimeOutMS() const;
+
     /**
      * 从缓存池获取一片缓存
      * @return 一片缓存
@@ -388,7 +393,7 @@ public:
      * 获取poller线程对象
      * @return poller线程对象
      */
-    virtual const EventPoller::Ptr &getPoller() const;
+    virtual EventPoller::Ptr getPoller() const;
 
     /**
      * 从另外一个Socket克隆
@@ -398,6 +403,15 @@ public:
      */
     virtual bool cloneFromListenSocket(const Socket &other);
 
+    /**
+     * 把已连接的tcp socket迁移到其他poller线程，必须在当前poller线程中调用
+     * 调用后立即停止收数据，当前poller线程处理完本轮事件后才会切换poller，
+     * 迁移期间不会触发任何事件，未发送的数据在迁移完成后继续发送
+     * @param poller 目标poller
+     * @param cb 在目标poller线程中回调迁移结果
+     */
+    void moveToPoller(const EventPoller::Ptr &poller, const function<void(bool success)> &cb);
+
     /**
      * 设置UDP发送数据时的目标地址，后续发送时就不用再单独指定了
      * @param dst_addr 目标地址
@@ -415,11 +429,40 @@ public:
      */
     virtual int getSendBufferCount();
 
+    /**
+     * 获取udp收包统计，linux下udp socket使用recvmmsg批量收包
+     * @param batches 收包批次数(成功的recvmmsg调用次数)
+     * @param packets 收包个数，packets / batches即为平均每批收包个数
+     * @param drops 因socket接收缓存满被内核丢弃的包个数(SO_RXQ_OVFL)
+     */
+    void getUdpRecvStat(uint64_t &batches, uint64_t &packets, uint64_t &drops) const;
+
     /**
      * 获取上次socket发送缓存清空至今的毫秒数,单位毫秒
      */
     virtual uint64_t elapsedTimeAfterFlushed();
 
+    /**
+     * 获取发送缓存(包括一级、二级缓存)中尚未写入socket的字节数
+     */
+    uint64_t getSendBufferBytes() const;
+
+    /**
+     * 开启MSG_ZEROCOPY零拷贝发送，仅对已连接的tcp socket有效
+     * 一次写入socket的数据不小于min_size字节时使用零拷贝，其Buffer在内核发送完成前保持引用
+     * 内核持续回退为拷贝发送(例如本机回环)时自动关闭
+     * @param min_size 使用零拷贝的最小字节数，为0时关闭
+     * @return 是否成功
+     */
+    bool enableZeroCopy(uint32_t min_size);
+
+    /**
+     * 获取零拷贝发送统计，按sendmsg调用次数计算
+     * @param hits 内核实际零拷贝发送的次数
+     * @param copied 内核回退为拷贝发送的次数
+     */
+    void getZeroCopyStat(uint64_t &hits, uint64_t &copied) const;
+
     ////////////SockInfo override////////////
     string get_local_ip() override;
     uint16_t get_local_port() override;
@@ -432,6 +475,7 @@ private:
     SockFD::Ptr makeSock(int sock,SockNum::SockType type);
     int onAccept(const SockFD::Ptr &sock, int event) noexcept;
     int onRead(const SockFD::Ptr &sock, bool is_udp = false) noexcept;
+    int onReadUdp(const SockFD::Ptr &sock) noexcept;
     void onError(const SockFD::Ptr &sock);
     void onWriteAble(const SockFD::Ptr &sock);
     void onConnected(const SockFD::Ptr &sock, const onErrCB &cb);
@@ -441,6 +485,17 @@ private:
     bool listen(const SockFD::Ptr &sock);
     bool flushData(const SockFD::Ptr &sock, bool poller_thread);
     bool attachEvent(const SockFD::Ptr &sock, bool is_udp = false);
+    void onZeroCopySent(List<Buffer::Ptr> &sent);
+    bool onZeroCopyNotify(const SockFD::Ptr &sock);
+    void onZeroCopyComplete(uint32_t lo, uint32_t hi, bool copied);
+
+private:
+    //零拷贝发送中等待内核完成通知的Buffer
+    class ZeroCopyPending {
+    public:
+        bool done = false;
+        List<Buffer::Ptr> buffers;
+    };
 
 private:
     //send socket时的flag
@@ -451,6 +506,18 @@ private:
     atomic<bool> _enable_recv {true};
     //标记该socket是否可写，socket写缓存满了就不可写
     atomic<bool> _sendable {true};
+    //发送缓存中尚未写入socket的字节数
+    atomic<uint64_t> _send_buf_bytes {0};
+    //使用零拷贝发送的最小字节数，为0时未开启
+    atomic<uint32_t> _zero_copy_min_size {0};
+    //零拷贝发送统计
+    atomic<uint64_t> _zero_copy_hits {0};
+    atomic<uint64_t> _zero_copy_copied {0};
+    //连续回退为拷贝发送的次数
+    uint32_t _zero_copy_copied_continuous = 0;
+    //_zero_copy_pending首个元素对应的内核通知序号，每次零拷贝sendmsg成功序号加1
+    uint32_t _zero_copy_head_id = 0;
+    std::deque<ZeroCopyPending> _zero_copy_pending;
 
     //tcp连接超时定时器
     Timer::Ptr _con_timer;
@@ -461,6 +528,12 @@ private:
     Ticker _send_flush_ticker;
     //复用的socket读缓存，每次read socket后，数据存放在此
     BufferRaw::Ptr _read_buffer;
+    //udp收包统计
+    atomic<uint64_t> _udp_recv_batches {0};
+    atomic<uint64_t> _udp_recv_packets {0};
+    atomic<uint64_t> _udp_recv_drops {0};
+    //SO_RXQ_OVFL为累计值，记录上次的值以便计算增量
+    uint32_t _udp_last_ovfl = 0;
     //socket fd的抽象类
     SockFD::Ptr _sock_fd;
     //本socket绑定的poller线程，事件触发于此线程
@@ -489,6 +562,8 @@ private:
     List<BufferList::Ptr> _send_buf_sending;
     //二级发送缓存锁
     MutexWrapper<recursive_mutex> _mtx_send_buf_sending;
+    //零拷贝发送等待列队锁
+    MutexWrapper<recursive_mutex> _mtx_zero_copy;
 };
 
 class SockSender {
@@ -528,7 +603,7 @@ public:
     /**
      * 获取poller线程
      */
-    const EventPoller::Ptr& getPoller() const;
+    EventPoller::Ptr getPoller() const;
 
     /**
      * 设置批量发送标记,用于提升性能
@@ -547,6 +622,32 @@ public:
      */
     bool isSocketBusy() const;
 
+    /**
+     * 获取发送缓存中尚未写入socket的字节数
+     */
+    uint64_t getSendBufferBytes() const;
+
+    /**
+     * 获取上次发送缓存清空至今的毫秒数
+     */
+    uint64_t elapsedTimeAfterFlushed() const;
+
+    /**
+     * 获取发送超时主动断开时间，单位毫秒
+     */
+    uint32_t getSendTimeOutMS() const;
+
+    /**
+     * 开启MSG_ZEROCOPY零拷贝发送
+     * @param min_size 使用零拷贝的最小字节数，为0时关闭
+     */
+    bool enableZeroCopy(uint32_t min_size);
+
+    /**
+     * 获取零拷贝发送统计
+     */
+    void getZeroCopyStat(uint64_t &hits, uint64_t &copied) const;
+
     /**
      * 从缓存池中获取一片缓存
      * @param data 需要拷贝的数据
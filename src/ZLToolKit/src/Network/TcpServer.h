@@ -109,6 +109,11 @@ public:
         return _session;
     }
 
+    //会话迁移到其他TcpServer实例后更新
+    void setServer(const std::weak_ptr<TcpServer> &server) {
+        _server = server;
+    }
+
 private:
     string _identifier;
     TcpSession::Ptr _session;
@@ -153,6 +158,8 @@ public:
     template <typename SessionType>
     void start(uint16_t port, const std::string &host = "0.0.0.0", uint32_t backlog = 1024) {
         start_l<SessionType>(port, host, backlog);
+        _server_map = std::make_shared<ServerMap>();
+        registServer();
         EventPollerPool::Instance().for_each([&](const TaskExecutor::Ptr &executor) {
             EventPoller::Ptr poller = dynamic_pointer_cast<EventPoller>(executor);
             if (poller == _poller || !poller) {
@@ -219,18 +226,81 @@ protected:
         }, _poller);
         this->mINI::operator=(that);
         _cloned = true;
+        _server_map = that._server_map;
+        registServer();
     }
 
     // 接收到客户端连接请求
     virtual void onAcceptConnection(const Socket::Ptr &sock) {
         assert(_poller->isCurrentThread());
-        weak_ptr<TcpServer> weak_self = shared_from_this();
         //创建一个TcpSession;这里实现创建不同的服务会话实例
         auto helper = _session_alloc(shared_from_this(), sock);
         auto &session = helper->session();
         //把本服务器的配置传递给TcpSession
         session->attachServer(*this);
 
+        attachSession(helper, sock);
+    }
+
+    /**
+     * 把会话迁移到目标poller线程对应的TcpServer实例，在本实例poller线程中调用
+     * @param ptr 会话
+     * @param sock 会话socket
+     * @param poller 目标poller
+     * @param cb 在目标poller线程中回调
+     * @return 能否迁移
+     */
+    bool migrateSession(TcpSessionHelper *ptr, const Socket::Ptr &sock, const EventPoller::Ptr &poller, const function<void()> &cb) {
+        assert(_poller->isCurrentThread());
+        weak_ptr<TcpServer> weak_target;
+        if (_server_map) {
+            lock_guard<mutex> lck(_server_map->mtx);
+            auto it = _server_map->servers.find(poller.get());
+            if (it != _server_map->servers.end()) {
+                weak_target = it->second;
+            }
+        }
+        auto target = weak_target.lock();
+        auto it = _session_map.find(ptr);
+        if (!target || target.get() == this || it == _session_map.end()) {
+            return false;
+        }
+
+        //会话对象随lambda转移至目标TcpServer，期间不受本实例管理
+        auto helper = it->second;
+        if (!_is_on_manager) {
+            _session_map.erase(it);
+        } else {
+            weak_ptr<TcpServer> weak_self = shared_from_this();
+            _poller->async([weak_self, ptr]() {
+                auto strong_self = weak_self.lock();
+                if (strong_self) {
+                    strong_self->_session_map.erase(ptr);
+                }
+            }, false);
+        }
+
+        sock->moveToPoller(poller, [weak_target, helper, sock, cb](bool success) {
+            auto target = weak_target.lock();
+            if (!success || !target) {
+                //会话已经脱离原TcpServer，直接触发onError后随helper销毁
+                sock->setOnErr(nullptr);
+                helper->session()->onError(SockException(Err_other, "migrate tcp session failed"));
+                return;
+            }
+            helper->setServer(target);
+            target->attachSession(helper, sock);
+            cb();
+        });
+        return true;
+    }
+
+private:
+    //添加会话并监听其socket事件
+    void attachSession(const TcpSessionHelper::Ptr &helper, const Socket::Ptr &sock) {
+        assert(_poller->isCurrentThread());
+        weak_ptr<TcpServer> weak_self = shared_from_this();
+        auto &session = helper->session();
         //_session_map::emplace肯定能成功
         auto success = _session_map.emplace(helper.get(), helper).second;
         assert(success == true);
@@ -280,6 +350,22 @@ protected:
                 strong_session->onError(err);
             }
         });
+
+        weak_ptr<Socket> weak_sock = sock;
+        session->setOnMigrate([weak_self, ptr, weak_sock](const EventPoller::Ptr &poller, const function<void()> &cb) {
+            auto strong_self = weak_self.lock();
+            auto strong_sock = weak_sock.lock();
+            if (!strong_self || !strong_sock) {
+                return false;
+            }
+            //会话迁移后，该回调会被目标TcpServer重新设置
+            return strong_self->migrateSession(ptr, strong_sock, poller, cb);
+        });
+    }
+
+    void registServer() {
+        lock_guard<mutex> lck(_server_map->mtx);
+        _server_map->servers[_poller.get()] = shared_from_this();
     }
 
 private:
@@ -344,8 +430,16 @@ private:
         return _on_create_socket(_poller);
     }
     
+private:
+    //同一监听端口在各个poller线程的TcpServer实例，用于会话迁移
+    struct ServerMap {
+        mutex mtx;
+        unordered_map<EventPoller *, weak_ptr<TcpServer> > servers;
+    };
+
 private:
     bool _cloned = false;
+    std::shared_ptr<ServerMap> _server_map;
     bool _is_on_manager = false;
     Socket::Ptr _socket;
     EventPoller::Ptr _poller;
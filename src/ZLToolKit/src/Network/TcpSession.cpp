@@ -33,5 +33,29 @@ void TcpSession::safeShutdown(const SockException &ex){
     });
 }
 
+void TcpSession::setOnMigrate(onMigrate cb) {
+    _on_migrate = std::move(cb);
+}
+
+void TcpSession::migrateTo(const EventPoller::Ptr &poller, const function<void(bool success)> &cb) {
+    if (!_on_migrate || !poller || poller == getPoller()) {
+        cb(false);
+        return;
+    }
+    std::weak_ptr<TcpSession> weak_self = shared_from_this();
+    auto success = _on_migrate(poller, [weak_self, poller, cb]() {
+        //此时已经在目标poller线程
+        auto strong_self = weak_self.lock();
+        if (!strong_self) {
+            return;
+        }
+        strong_self->setPoller(poller);
+        cb(true);
+    });
+    if (!success) {
+        cb(false);
+    }
+}
+
 } /* namespace toolkit */
 
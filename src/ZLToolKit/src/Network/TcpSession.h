@@ -66,6 +66,25 @@ public:
      * @param ex 触发onError事件的原因
      */
     void safeShutdown(const SockException &ex = SockException(Err_shutdown, "self shutdown"));
+
+    /**
+     * 把会话迁移到同一TcpServer在其他poller线程的实例中，必须在会话所在poller线程中调用
+     * 调用后会话不应再做任何操作，直到在目标poller线程中回调cb(true)；
+     * 无法迁移时(例如会话不属于TcpServer)同步回调cb(false)，会话不受影响；
+     * 迁移过程中失败时会话将被shutdown，不回调cb
+     * @param poller 目标poller
+     * @param cb 迁移结果回调
+     */
+    void migrateTo(const EventPoller::Ptr &poller, const function<void(bool success)> &cb);
+
+    /**
+     * 由TcpServer设置的会话迁移实现
+     */
+    using onMigrate = function<bool(const EventPoller::Ptr &poller, const function<void()> &cb)>;
+    void setOnMigrate(onMigrate cb);
+
+private:
+    onMigrate _on_migrate;
 };
 
 } /* namespace toolkit */
@@ -320,17 +320,30 @@ int SockUtil::getSockError(int sockFd) {
     }
 }
 
+static string sockaddr_ip(const struct sockaddr_storage &addr) {
+    char buf[INET6_ADDRSTRLEN] = {0};
+    switch (addr.ss_family) {
+        case AF_INET: return inet_ntop(AF_INET, &((struct sockaddr_in *) &addr)->sin_addr, buf, sizeof(buf)) ? buf : "";
+        case AF_INET6: return inet_ntop(AF_INET6, &((struct sockaddr_in6 *) &addr)->sin6_addr, buf, sizeof(buf)) ? buf : "";
+        default: return "";
+    }
+}
+
+static uint16_t sockaddr_port(const struct sockaddr_storage &addr) {
+    switch (addr.ss_family) {
+        case AF_INET: return ntohs(((struct sockaddr_in *) &addr)->sin_port);
+        case AF_INET6: return ntohs(((struct sockaddr_in6 *) &addr)->sin6_port);
+        default: return 0;
+    }
+}
+
 std::string SockUtil::get_local_ip(int fd) {
-    struct sockaddr addr;
-    struct sockaddr_in* addr_v4;
+    //获取local ip，兼容ipv6
+    struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
-    //获取local ip and port
     memset(&addr, 0, sizeof(addr));
-    if (0 == getsockname(fd, &addr, &addr_len)) {
-        if (addr.sa_family == AF_INET) {
-            addr_v4 = (sockaddr_in*) &addr;
-            return SockUtil::inet_ntoa(addr_v4->sin_addr);
-        }
+    if (0 == getsockname(fd, (struct sockaddr *) &addr, &addr_len)) {
+        return sockaddr_ip(addr);
     }
     return "";
 }
@@ -411,29 +424,23 @@ SockUtil::getInterfaceList(){
 };
 
 uint16_t SockUtil::get_local_port(int fd) {
-    struct sockaddr addr;
-    struct sockaddr_in* addr_v4;
+    //获取local port，兼容ipv6
+    struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
-    //获取remote ip and port
-    if (0 == getsockname(fd, &addr, &addr_len)) {
-        if (addr.sa_family == AF_INET) {
-            addr_v4 = (sockaddr_in*) &addr;
-            return ntohs(addr_v4->sin_port);
-        }
+    memset(&addr, 0, sizeof(addr));
+    if (0 == getsockname(fd, (struct sockaddr *) &addr, &addr_len)) {
+        return sockaddr_port(addr);
     }
     return 0;
 }
 
 string SockUtil::get_peer_ip(int fd) {
-    struct sockaddr addr;
-    struct sockaddr_in* addr_v4;
+    //获取remote ip，兼容ipv6
+    struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
-    //获取remote ip and port
-    if (0 == getpeername(fd, &addr, &addr_len)) {
-        if (addr.sa_family == AF_INET) {
-            addr_v4 = (sockaddr_in*) &addr;
-            return SockUtil::inet_ntoa(addr_v4->sin_addr);
-        }
+    memset(&addr, 0, sizeof(addr));
+    if (0 == getpeername(fd, (struct sockaddr *) &addr, &addr_len)) {
+        return sockaddr_ip(addr);
     }
     return "";
 }
@@ -495,7 +502,9 @@ int SockUtil::bindSock(int sockFd,const char *ifr_ip,uint16_t port, int family){
 
 int SockUtil::bindUdpSock(const uint16_t port, const char* localIp) {
     int sockfd = -1;
-    if ((sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1) {
+    //本地地址为ipv6时创建ipv6 socket(非v6only，可以收发ipv4映射地址)
+    int family = support_ipv6() ? (is_ipv4(localIp) ? AF_INET : AF_INET6) : AF_INET;
+    if ((sockfd = socket(family, SOCK_DGRAM, IPPROTO_UDP)) == -1) {
         WarnL << "创建套接字失败:" << get_uv_errmsg(true);
         return -1;
     }
@@ -507,8 +516,13 @@ int SockUtil::bindUdpSock(const uint16_t port, const char* localIp) {
     setRecvBuf(sockfd);
     setCloseWait(sockfd);
     setCloExec(sockfd);
+#if defined(SO_RXQ_OVFL)
+    //收包时附带内核丢包计数
+    int on = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+#endif
 
-    if(bindSock(sockfd,localIp,port) == -1){
+    if(bindSock(sockfd,localIp,port,family) == -1){
         close(sockfd);
         return -1;
     }
@@ -516,15 +530,12 @@ int SockUtil::bindUdpSock(const uint16_t port, const char* localIp) {
 }
 
 uint16_t SockUtil::get_peer_port(int fd) {
-    struct sockaddr addr;
-    struct sockaddr_in* addr_v4;
+    //获取remote port，兼容ipv6
+    struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
-    //获取remote ip and port
-    if (0 == getpeername(fd, &addr, &addr_len)) {
-        if (addr.sa_family == AF_INET) {
-            addr_v4 = (sockaddr_in*) &addr;
-            return ntohs(addr_v4->sin_port);
-        }
+    memset(&addr, 0, sizeof(addr));
+    if (0 == getpeername(fd, (struct sockaddr *) &addr, &addr_len)) {
+        return sockaddr_port(addr);
     }
     return 0;
 }
@@ -1,6 +1,7 @@
 ﻿#include "EventPoller.h"
  
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <fcntl.h>
 #include <string.h>
 #include <list>
@@ -36,8 +37,10 @@ EventPoller &EventPoller::Instance() {
 
 EventPoller::EventPoller(ThreadPool::Priority priority ) {
     _priority = priority;
-    SockUtil::setNoBlocked(_pipe.readFD());
-    SockUtil::setNoBlocked(_pipe.writeFD());
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        throw runtime_error(StrPrinter << "创建eventfd失败:" << get_uv_errmsg());
+    }
 
     _epoll_fd = epoll_create(EPOLL_SIZE);
     if (_epoll_fd == -1) {
@@ -48,9 +51,9 @@ EventPoller::EventPoller(ThreadPool::Priority priority ) {
     _logger = Logger::Instance().shared_from_this();
     _loop_thread_id = this_thread::get_id();
 
-    //添加内部管道事件
-    if (addEvent(_pipe.readFD(), Event_Read, [this](int event) { onPipeEvent(); }) == -1) {
-        throw std::runtime_error("epoll添加管道失败");
+    //添加内部eventfd事件
+    if (addEvent(_event_fd, Event_Read, [this](int event) { onWakeupEvent(); }) == -1) {
+        throw std::runtime_error("epoll添加eventfd失败");
     }
 }
 
@@ -74,9 +77,13 @@ EventPoller::~EventPoller() {
         close(_epoll_fd);
         _epoll_fd = -1;
     }
-    //退出前清理管道中的数据
+    //退出前执行剩余的异步任务
     _loop_thread_id = this_thread::get_id();
-    onPipeEvent();
+    onWakeupEvent();
+    if (_event_fd != -1) {
+        close(_event_fd);
+        _event_fd = -1;
+    }
     InfoL << this;
 }
 
@@ -147,16 +154,19 @@ Task::Ptr EventPoller::async_l(TaskIn task,bool may_sync, bool first) {
     }
 
     auto ret = std::make_shared<Task>(std::move(task));
-    {
-        lock_guard<mutex> lck(_mtx_task);
-        if (first) {
-            _list_task.emplace_front(ret);
-        } else {
-            _list_task.emplace_back(ret);
-        }
+    if (first) {
+        _queue_task_first.push(ret);
+    } else {
+        _queue_task.push(ret);
+    }
+    //轮询线程处理前只需唤醒一次
+    if (!_wakeup_pending.exchange(true)) {
+        uint64_t value = 1;
+        int n;
+        do {
+            n = ::write(_event_fd, &value, sizeof(value));
+        } while (-1 == n && UV_EINTR == get_uv_error(true));
     }
-    //写数据到管道,唤醒主线程
-    _pipe.write("", 1);
     return ret;
 }
 
@@ -164,24 +174,29 @@ bool EventPoller::isCurrentThread() {
     return _loop_thread_id == this_thread::get_id();
 }
 
-inline void EventPoller::onPipeEvent() {
+inline void EventPoller::onWakeupEvent() {
     TimeTicker();
-    char buf[1024];
-    int err = 0;
+    uint64_t value;
+    int n;
     do {
-        if (_pipe.read(buf, sizeof(buf)) > 0) {
-            continue;
-        }
-        err = get_uv_error(true);
-    } while (err != UV_EAGAIN);
-
-    decltype(_list_task) _list_swap;
-    {
-        lock_guard<mutex> lck(_mtx_task);
-        _list_swap.swap(_list_task);
+        n = ::read(_event_fd, &value, sizeof(value));
+    } while (-1 == n && UV_EINTR == get_uv_error(true));
+    //必须在取任务前清除标记，否则可能漏掉唤醒
+    _wakeup_pending.store(false);
+
+    //只执行本次唤醒前入队的任务，执行期间新入队的任务下次唤醒再执行
+    List<Task::Ptr> list_task;
+    Task::Ptr task;
+    while (_queue_task_first.pop(task)) {
+        list_task.emplace_back(std::move(task));
     }
+    while (_queue_task.pop(task)) {
+        list_task.emplace_back(std::move(task));
+    }
+    ++_wakeup_count;
+    _async_task_count += list_task.size();
 
-    _list_swap.for_each([&](const Task::Ptr &task) {
+    list_task.for_each([&](const Task::Ptr &task) {
         try {
             (*task)();
         } catch (ExitException &ex) {
@@ -192,6 +207,14 @@ inline void EventPoller::onPipeEvent() {
     });
 }
 
+uint64_t EventPoller::getWakeupCount() const {
+    return _wakeup_count.load();
+}
+
+uint64_t EventPoller::getAsyncTaskCount() const {
+    return _async_task_count.load();
+}
+
 void EventPoller::wait() {
     lock_guard<mutex> lck(_mtx_runing);
 }
@@ -264,44 +287,41 @@ void EventPoller::runLoop(bool blocked,bool regist_self) {
 }
 
 uint64_t EventPoller::flushDelayTask(uint64_t now_time) {
-    decltype(_delay_task_map) task_copy;
-    task_copy.swap(_delay_task_map);
+    vector<DelayTask::Ptr> task_list;
+    _delay_task_wheel.expire(now_time, task_list);
 
-    for (auto it = task_copy.begin(); it != task_copy.end() && it->first <= now_time; it = task_copy.erase(it)) {
+    for (auto &task : task_list) {
         //已到期的任务
         try {
-            auto next_delay = (*(it->second))();
+            auto next_delay = (*task)();
             if (next_delay) {
                 //可重复任务,更新时间截止线
-                _delay_task_map.emplace(next_delay + now_time, std::move(it->second));
+                _delay_task_wheel.add(next_delay + now_time, std::move(task));
             }
         } catch (std::exception &ex) {
             ErrorL << "EventPoller执行延时任务捕获到异常:" << ex.what();
         }
     }
 
-    task_copy.insert(_delay_task_map.begin(), _delay_task_map.end());
-    task_copy.swap(_delay_task_map);
-
-    auto it = _delay_task_map.begin();
-    if (it == _delay_task_map.end()) {
+    auto next_tick = _delay_task_wheel.nextTick();
+    if (next_tick == UINT64_MAX) {
         //没有剩余的定时器了
         return 0;
     }
     //最近一个定时器的执行延时
-    return it->first - now_time;
+    return next_tick > now_time ? next_tick - now_time : 1;
 }
 
 uint64_t EventPoller::getMinDelay() {
-    auto it = _delay_task_map.begin();
-    if (it == _delay_task_map.end()) {
+    auto next_tick = _delay_task_wheel.nextTick();
+    if (next_tick == UINT64_MAX) {
         //没有剩余的定时器了
         return 0;
     }
     auto now = getCurrentMillisecond();
-    if (it->first > now) {
+    if (next_tick > now) {
         //所有任务尚未到期
-        return it->first - now;
+        return next_tick - now;
     }
     //执行已到期的任务并刷新休眠延时
     return flushDelayTask(now);
@@ -312,7 +332,7 @@ DelayTask::Ptr EventPoller::doDelayTask(uint64_t delayMS, function<uint64_t()> t
     auto time_line = getCurrentMillisecond() + delayMS;
     async_first([time_line, ret, this]() {
         //异步执行的目的是刷新select或epoll的休眠时间
-        _delay_task_map.emplace(time_line, ret);
+        _delay_task_wheel.add(time_line, ret);
     });
     return ret;
 }
@@ -17,10 +17,11 @@
 #include <functional>
 #include <memory>
 #include <unordered_map>
-#include "PipeWrap.h"
 #include "Util/logger.h"
 #include "Util/util.h"
 #include "Util/List.h"
+#include "Util/MpscQueue.h"
+#include "TimerWheel.h"
 #include "Thread/TaskExecutor.h"
 #include "Thread/ThreadPool.h"
 #include "Network/Buffer.h"
@@ -92,6 +93,16 @@ public:
      */
     BufferRaw::Ptr getSharedBuffer();
 
+    /**
+     * 获取被其他线程唤醒的次数
+     */
+    uint64_t getWakeupCount() const;
+
+    /**
+     * 获取异步任务执行总个数，与唤醒次数之比即为平均每次唤醒执行的任务个数
+     */
+    uint64_t getAsyncTaskCount() const;
+
 private:
     /**
      * 本对象只允许在EventPollerPool中构造
@@ -106,9 +117,9 @@ private:
     void runLoop(bool blocked , bool regist_self);
 
     /**
-     * 内部管道事件，用于唤醒轮询线程用
+     * 内部eventfd事件，用于唤醒轮询线程并执行异步任务
      */
-    void onPipeEvent();
+    void onWakeupEvent();
 
     /**
      * 切换线程并执行任务
@@ -164,11 +175,17 @@ private:
     //通知事件循环的线程已启动
     semaphore _sem_run_started;
 
-    //内部事件管道
-    PipeWrap _pipe;
+    //内部事件fd，用于唤醒轮询线程
+    int _event_fd = -1;
+    //已经写过eventfd且轮询线程尚未处理，此时入队的任务无需再次唤醒
+    atomic_bool _wakeup_pending {false};
     //从其他线程切换过来的任务
-    mutex _mtx_task;
-    List<Task::Ptr> _list_task;
+    MpscQueue<Task::Ptr> _queue_task;
+    //async_first切换过来的任务，优先执行
+    MpscQueue<Task::Ptr> _queue_task_first;
+    //唤醒次数与执行的异步任务个数统计
+    atomic<uint64_t> _wakeup_count {0};
+    atomic<uint64_t> _async_task_count {0};
 
     //保持日志可用
     Logger::Ptr _logger;
@@ -177,7 +194,7 @@ private:
     std::unordered_map<int, std::shared_ptr<PollEventCB>> _event_map;
 
     //定时器相关
-    std::multimap<uint64_t, DelayTask::Ptr> _delay_task_map;
+    TimerWheel<DelayTask::Ptr> _delay_task_wheel {getCurrentMillisecond()};
 };
 
 
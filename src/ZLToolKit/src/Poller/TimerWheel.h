@@ -0,0 +1,199 @@
+﻿/*
+ * Copyright (c) 2016 The ZLToolKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLToolKit(https://github.com/xiongziliang/ZLToolKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLTOOLKIT_TIMERWHEEL_H
+#define ZLTOOLKIT_TIMERWHEEL_H
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+using namespace std;
+
+namespace toolkit {
+
+/**
+ * 分层时间轮，刻度为1毫秒
+ * 第0层256个槽，第1~3层各64个槽，覆盖约18.6小时，更长的定时器到期前会重新放入时间轮
+ * 添加定时器为O(1)，到期时按槽批量取出，高层槽在轮转到时才降级到低层
+ * 本对象非线程安全，应该只在poller线程中操作
+ * @tparam T 定时器数据
+ */
+template<typename T>
+class TimerWheel {
+public:
+    TimerWheel(uint64_t now) {
+        _current = now;
+    }
+
+    ~TimerWheel() = default;
+
+    /**
+     * 添加定时器
+     * @param expire 到期时间点(毫秒)
+     * @param data 定时器数据
+     */
+    void add(uint64_t expire, T data) {
+        ++_size;
+        place(expire, std::move(data));
+    }
+
+    /**
+     * 取出所有到期的定时器
+     * @param now 当前时间点(毫秒)
+     * @param out 到期的定时器按到期先后顺序追加到此
+     */
+    void expire(uint64_t now, vector<T> &out) {
+        while (_size) {
+            auto tick = nextTick();
+            if (tick > now) {
+                break;
+            }
+            //跳过中间的空槽
+            _current = tick;
+            cascade();
+            auto &slot = _wheel0[tick & kSlotMask0];
+            for (auto &entry : slot) {
+                out.emplace_back(std::move(entry.second));
+            }
+            _size -= slot.size();
+            slot.clear();
+            _bits0[(tick & kSlotMask0) >> 6] &= ~(1ULL << (tick & 63));
+            _current = tick + 1;
+        }
+        if (_current <= now) {
+            _current = now + 1;
+        }
+    }
+
+    /**
+     * 获取下次需要处理的时间点，可能是定时器到期或者高层槽降级
+     * 没有定时器时返回UINT64_MAX
+     */
+    uint64_t nextTick() const {
+        if (!_size) {
+            return UINT64_MAX;
+        }
+        uint64_t ret = UINT64_MAX;
+        auto dis = nextSetBit(_bits0, 4, _current & kSlotMask0);
+        if (dis >= 0) {
+            ret = _current + dis;
+        }
+        for (int level = 1; level < kLevels; ++level) {
+            auto shift = levelShift(level);
+            //下一个该层轮转的边界
+            auto boundary = ((_current + (1ULL << shift) - 1) >> shift) << shift;
+            auto dis = nextSetBit(&_bits[level], 1, (boundary >> shift) & kSlotMask);
+            if (dis >= 0) {
+                auto tick = boundary + ((uint64_t) dis << shift);
+                ret = tick < ret ? tick : ret;
+            }
+        }
+        return ret;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr uint64_t kSlotMask0 = 255;
+    static constexpr uint64_t kSlotMask = 63;
+
+    static int levelShift(int level) {
+        return 8 + 6 * (level - 1);
+    }
+
+    /**
+     * 在环形位图中查找start开始的第一个置位
+     * @return 距离start的偏移，没有置位时返回-1
+     */
+    static int nextSetBit(const uint64_t *bits, int words, int start) {
+        int total = words * 64;
+        for (int dis = 0; dis < total;) {
+            auto pos = (start + dis) % total;
+            auto bit = pos & 63;
+            auto value = bits[pos >> 6] >> bit;
+            if (value) {
+                return dis + __builtin_ctzll(value);
+            }
+            dis += 64 - bit;
+        }
+        return -1;
+    }
+
+    void place(uint64_t expire, T data) {
+        if (expire < _current) {
+            //已经过期的定时器下次立即执行
+            expire = _current;
+        }
+        auto delta = expire - _current;
+        if (delta <= kSlotMask0) {
+            auto idx = expire & kSlotMask0;
+            _wheel0[idx].emplace_back(expire, std::move(data));
+            _bits0[idx >> 6] |= 1ULL << (idx & 63);
+            return;
+        }
+        int level = 1;
+        while (level < kLevels - 1 && delta >> (levelShift(level) + 6)) {
+            ++level;
+        }
+        auto shift = levelShift(level);
+        auto pos = expire;
+        if (delta >> (shift + 6)) {
+            //超出时间轮范围，先放入最高层最远的槽，降级时再重新放置
+            pos = _current + (1ULL << (shift + 6)) - 1;
+        }
+        auto idx = (pos >> shift) & kSlotMask;
+        _wheel[level][idx].emplace_back(expire, std::move(data));
+        _bits[level] |= 1ULL << idx;
+    }
+
+    /**
+     * 轮转到高层槽的边界时，把该槽的定时器降级放置
+     */
+    void cascade() {
+        if (_current & kSlotMask0) {
+            return;
+        }
+        //从高层到低层，使降级下来的定时器能继续降级
+        int top = 1;
+        while (top < kLevels - 1 && !(_current & ((1ULL << levelShift(top + 1)) - 1))) {
+            ++top;
+        }
+        for (int level = top; level > 0; --level) {
+            auto idx = (_current >> levelShift(level)) & kSlotMask;
+            if (!(_bits[level] & (1ULL << idx))) {
+                continue;
+            }
+            vector<pair<uint64_t, T> > slot;
+            slot.swap(_wheel[level][idx]);
+            _bits[level] &= ~(1ULL << idx);
+            for (auto &entry : slot) {
+                place(entry.first, std::move(entry.second));
+            }
+        }
+    }
+
+private:
+    //下一个待处理的时间点
+    uint64_t _current;
+    size_t _size = 0;
+    //各槽是否有定时器的位图
+    uint64_t _bits0[4] = {0};
+    uint64_t _bits[kLevels] = {0};
+    //第0层时间轮
+    vector<pair<uint64_t, T> > _wheel0[kSlotMask0 + 1];
+    //第1~3层时间轮，下标0不使用
+    vector<pair<uint64_t, T> > _wheel[kLevels][kSlotMask + 1];
+};
+
+} /* namespace toolkit */
+#endif //ZLTOOLKIT_TIMERWHEEL_H
@@ -0,0 +1,93 @@
+﻿/*
+ * Copyright (c) 2016 The ZLToolKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLToolKit(https://github.com/xiongziliang/ZLToolKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLTOOLKIT_MPSCQUEUE_H
+#define ZLTOOLKIT_MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+using namespace std;
+
+namespace toolkit {
+
+/**
+ * 多生产者单消费者无锁队列(Vyukov算法)
+ * push可以在任意线程并发调用，pop只能在同一个消费线程调用
+ * 生产者只有一次原子交换，不会因为加锁而阻塞
+ * @tparam T 需支持默认构造与移动
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        //哨兵节点
+        _tail = new Node;
+        _head.store(_tail, memory_order_relaxed);
+    }
+
+    ~MpscQueue() {
+        T tmp;
+        while (pop(tmp));
+        delete _tail;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * 入队，任意线程调用
+     */
+    template<typename ...ARGS>
+    void push(ARGS &&...args) {
+        auto node = new Node(std::forward<ARGS>(args)...);
+        auto prev = _head.exchange(node, memory_order_acq_rel);
+        //在此之前消费者看不到该节点及其之后入队的节点
+        prev->next.store(node, memory_order_release);
+    }
+
+    /**
+     * 出队，只能在消费线程调用
+     * @param out 出队的数据
+     * @return 队列为空(或者生产者尚未完成入队)时返回false
+     */
+    bool pop(T &out) {
+        auto next = _tail->next.load(memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(next->data);
+        //出队的节点成为新的哨兵节点
+        delete _tail;
+        _tail = next;
+        return true;
+    }
+
+private:
+    class Node {
+    public:
+        Node() = default;
+
+        template<typename ...ARGS>
+        explicit Node(ARGS &&...args) : data(std::forward<ARGS>(args)...) {}
+
+    public:
+        T data;
+        atomic<Node *> next {nullptr};
+    };
+
+private:
+    //生产者写入端
+    atomic<Node *> _head;
+    //消费者读取端(哨兵节点)
+    Node *_tail;
+};
+
+} /* namespace toolkit */
+#endif //ZLTOOLKIT_MPSCQUEUE_H
@@ -13,6 +13,7 @@
 
 #include <mutex>
 #include <deque>
+#include <cstddef>
 #include <memory>
 #include <atomic>
 #include <functional>
@@ -29,6 +30,78 @@ namespace toolkit {
 
 template<typename C>
 class ResourcePool_l;
+template<typename C>
+class shared_ptr_imp;
+
+/**
+ * 循环池中的对象节点，对象、放弃循环标记以及shared_ptr控制块共用一块内存，
+ * 节点在循环池中反复使用，obtain时不再分配内存
+ */
+template<typename C>
+class ResourceNode {
+public:
+#if defined(SUPPORT_DYNAMIC_TEMPLATE)
+    template<typename ...ArgTypes>
+    ResourceNode(ArgTypes &&...args) : _obj(std::forward<ArgTypes>(args)...) {}
+#else
+    ResourceNode() {}
+#endif //defined(SUPPORT_DYNAMIC_TEMPLATE)
+
+private:
+    friend class ResourcePool_l<C>;
+    template<typename T, typename D> friend class ResourceAllocator;
+    friend class shared_ptr_imp<C>;
+
+    C _obj;
+    atomic_bool _quit{false};
+    ResourceNode *_next = nullptr;
+    ResourcePool_l<C> *_pool = nullptr;
+    //shared_ptr控制块(_Sp_counted_deleter)的存储空间
+    typename std::aligned_storage<64, alignof(std::max_align_t)>::type _ctrl;
+};
+
+/**
+ * shared_ptr控制块分配器，控制块放在节点内部；
+ * 控制块释放(即最后一个shared_ptr/weak_ptr析构)时把节点归还循环池
+ */
+template<typename T, typename C>
+class ResourceAllocator {
+public:
+    typedef T value_type;
+
+    explicit ResourceAllocator(ResourceNode<C> *node) : _node(node) {}
+
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U, C> &that) : _node(that._node) {}
+
+    T *allocate(size_t n) {
+        if (sizeof(T) * n <= sizeof(_node->_ctrl) && alignof(T) <= alignof(std::max_align_t)) {
+            return (T *) &_node->_ctrl;
+        }
+        return (T *) ::operator new(sizeof(T) * n);
+    }
+
+    void deallocate(T *ptr, size_t /*n*/) {
+        if ((void *) ptr != (void *) &_node->_ctrl) {
+            ::operator delete(ptr);
+        }
+        ResourcePool_l<C>::recycle(_node);
+    }
+
+    template<typename U>
+    bool operator==(const ResourceAllocator<U, C> &that) const {
+        return _node == that._node;
+    }
+
+    template<typename U>
+    bool operator!=(const ResourceAllocator<U, C> &that) const {
+        return _node != that._node;
+    }
+
+private:
+    template<typename U, typename D> friend class ResourceAllocator;
+    ResourceNode<C> *_node;
+};
 
 template<typename C>
 class shared_ptr_imp : public std::shared_ptr<C> {
@@ -37,11 +110,9 @@ public:
 
     /**
      * 构造智能指针
-     * @param ptr 裸指针
-     * @param weakPool 管理本指针的循环池
-     * @param quit 对接是否放弃循环使用
+     * @param node 循环池节点，引用计数归零时回到循环池
      */
-    shared_ptr_imp(C *ptr,const std::weak_ptr<ResourcePool_l<C> > &weakPool , const std::shared_ptr<atomic_bool> &quit) ;
+    shared_ptr_imp(ResourceNode<C> *node);
 
     /**
      * 放弃或恢复回到循环池继续使用
@@ -53,65 +124,150 @@ public:
         }
     }
 private:
-    std::shared_ptr<atomic_bool> _quit;
+    atomic_bool *_quit = nullptr;
 };
 
-
+/**
+ * 循环池实现
+ * 对象归还可能发生在任意线程，通过无锁栈归还；
+ * obtain一般只在产生数据的线程调用，优先从本地空闲链表获取，本地链表为空时一次性取走所有归还的对象，
+ * 其他线程同时obtain时不等待，直接新建对象
+ */
 template<typename C>
-class ResourcePool_l: public enable_shared_from_this<ResourcePool_l<C> > {
+class ResourcePool_l {
 public:
     typedef shared_ptr_imp<C> ValuePtr;
-    friend class shared_ptr_imp<C>;
+    typedef ResourceNode<C> Node;
+    template<typename T, typename D> friend class ResourceAllocator;
+
     ResourcePool_l() {
-        _allotter = []()->C* {
-            return new C();
+        _allotter = []()->Node* {
+            return new Node();
         };
     }
 
 #if defined(SUPPORT_DYNAMIC_TEMPLATE)
     template<typename ...ArgTypes>
     ResourcePool_l(ArgTypes &&...args) {
-        _allotter = [args...]()->C* {
-            return new C(args...);
+        _allotter = [args...]()->Node* {
+            return new Node(args...);
         };
     }
 #endif //defined(SUPPORT_DYNAMIC_TEMPLATE)
 
-    ~ResourcePool_l(){
-        std::lock_guard<decltype(_mutex)> lck(_mutex);
-        _objs.for_each([](C *ptr){
-            delete ptr;
-        });
-    }
     void setSize(int size) {
         _poolsize = size;
     }
 
     ValuePtr obtain() {
-        std::lock_guard<decltype(_mutex)> lck(_mutex);
-        C *ptr;
-        if (_objs.size() == 0) {
-            ptr = _allotter();
-        } else {
-            ptr = _objs.front();
-            _objs.pop_front();
+        auto node = popLocal();
+        if (!node) {
+            node = _allotter();
+            node->_pool = this;
+            _ref.fetch_add(1, memory_order_relaxed);
         }
-        return ValuePtr(ptr,this->shared_from_this(),std::make_shared<atomic_bool>(false));
+        node->_quit = false;
+        return ValuePtr(node);
+    }
+
+    /**
+     * 循环池对象析构时调用，释放所有空闲对象，
+     * 此后归还的对象直接释放，最后一个对象释放时销毁本对象
+     */
+    void close() {
+        while (_local_busy.test_and_set(memory_order_acquire));
+        auto local = _local;
+        _local = nullptr;
+        _local_busy.clear(memory_order_release);
+        destroyList(local);
+        destroyList(_returned.exchange(closedTag(), memory_order_acquire));
+        release();
     }
+
 private:
-    void recycle(C *obj) {
-        std::lock_guard<decltype(_mutex)> lck(_mutex);
-        if ((int)_objs.size() >= _poolsize) {
-            delete obj;
+    static Node *closedTag() {
+        return reinterpret_cast<Node *>(1);
+    }
+
+    Node *popLocal() {
+        if (_local_busy.test_and_set(memory_order_acquire)) {
+            //其他线程正在obtain
+            return nullptr;
+        }
+        if (!_local) {
+            refill();
+        }
+        auto node = _local;
+        if (node) {
+            _local = node->_next;
+        }
+        _local_busy.clear(memory_order_release);
+        return node;
+    }
+
+    void refill() {
+        //取走所有归还的对象，超过循环池大小的部分释放掉
+        auto node = _returned.exchange(nullptr, memory_order_acquire);
+        if (_poolsize <= 0) {
+            destroyList(node);
             return;
         }
-        _objs.emplace_back(obj);
+        _local = node;
+        for (int i = 1; node && i < _poolsize; ++i) {
+            node = node->_next;
+        }
+        if (node) {
+            destroyList(node->_next);
+            node->_next = nullptr;
+        }
+    }
+
+    static void recycle(Node *node) {
+        if (!node->_quit) {
+            //入栈后循环池可能已被其他线程销毁，不能再访问
+            auto pool = node->_pool;
+            auto head = pool->_returned.load(memory_order_relaxed);
+            do {
+                if (head == closedTag()) {
+                    break;
+                }
+                node->_next = head;
+            } while (!pool->_returned.compare_exchange_weak(head, node, memory_order_release, memory_order_relaxed));
+            if (head != closedTag()) {
+                return;
+            }
+        }
+        destroy(node);
     }
+
+    static void destroy(Node *node) {
+        auto pool = node->_pool;
+        delete node;
+        pool->release();
+    }
+
+    static void destroyList(Node *node) {
+        while (node) {
+            auto next = node->_next;
+            destroy(node);
+            node = next;
+        }
+    }
+
+    void release() {
+        if (_ref.fetch_sub(1, memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
 private:
-    List<C*> _objs;
-    function<C*(void)> _allotter;
-    mutex _mutex;
     int _poolsize = 8;
+    //本对象的引用计数，循环池和每个节点各持有一个
+    atomic<int> _ref{1};
+    atomic_flag _local_busy = ATOMIC_FLAG_INIT;
+    Node *_local = nullptr;
+    atomic<Node *> _returned{nullptr};
+    function<Node*(void)> _allotter;
 };
 
 /**
@@ -123,12 +279,16 @@ class ResourcePool {
 public:
     typedef shared_ptr_imp<C> ValuePtr;
     ResourcePool() {
-            pool.reset(new ResourcePool_l<C>());
+        pool.reset(new ResourcePool_l<C>(), [](ResourcePool_l<C> *ptr) {
+            ptr->close();
+        });
     }
 #if defined(SUPPORT_DYNAMIC_TEMPLATE)
     template<typename ...ArgTypes>
     ResourcePool(ArgTypes &&...args) {
-        pool = std::make_shared<ResourcePool_l<C> >(std::forward<ArgTypes>(args)...);
+        pool.reset(new ResourcePool_l<C>(std::forward<ArgTypes>(args)...), [](ResourcePool_l<C> *ptr) {
+            ptr->close();
+        });
     }
 #endif //defined(SUPPORT_DYNAMIC_TEMPLATE)
     void setSize(int size) {
@@ -142,18 +302,10 @@ private:
 };
 
 template<typename C>
-shared_ptr_imp<C>::shared_ptr_imp(C *ptr,
-                                  const std::weak_ptr<ResourcePool_l<C> > &weakPool ,
-                                  const std::shared_ptr<atomic_bool> &quit ) :
-        shared_ptr<C>(ptr,[weakPool,quit](C *ptr){
-            auto strongPool = weakPool.lock();
-            if (strongPool && !(*quit)) {
-                //循环池还在并且不放弃放入循环池
-                strongPool->recycle(ptr);
-            } else {
-                delete ptr;
-            }
-        }),_quit(quit) {}
+shared_ptr_imp<C>::shared_ptr_imp(ResourceNode<C> *node) : _quit(&node->_quit) {
+    //对象随节点复用，删除器不做任何事，控制块释放时才把节点归还循环池，这样weak_ptr也是安全的
+    std::shared_ptr<C>::reset(&node->_obj, [](C *) {}, ResourceAllocator<C, C>(node));
+}
 
 } /* namespace toolkit */
 #endif /* UTIL_RECYCLEPOOL_H_ */
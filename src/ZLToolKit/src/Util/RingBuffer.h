@@ -63,6 +63,7 @@ public:
     ~_RingReader() {}
 
     void setReadCB(const function<void(const T &)> &cb) {
+        _read_key_cb = nullptr;
         if (!cb) {
             _read_cb = [](const T &) {};
         } else {
@@ -71,6 +72,20 @@ public:
         }
     }
 
+    /**
+     * 设置读取回调，回调附带该数据是否为gop开始(关键帧)
+     * 可用于慢速播放器丢帧等场景
+     */
+    void setReadKeyCB(const function<void(const T &, bool is_key)> &cb) {
+        if (!cb) {
+            _read_key_cb = nullptr;
+            _read_cb = [](const T &) {};
+        } else {
+            _read_key_cb = cb;
+            flushGop();
+        }
+    }
+
     void setDetachCB(const function<void()> &cb) {
         if (!cb) {
             _detach_cb = []() {};
@@ -81,7 +96,11 @@ public:
 
 private:
     void onRead(const T &data, bool is_key) {
-        _read_cb(data);
+        if (_read_key_cb) {
+            _read_key_cb(data, is_key);
+        } else {
+            _read_cb(data);
+        }
     }
 
     void onDetach() const {
@@ -92,23 +111,59 @@ private:
         if (!_use_cache) {
             return;
         }
-        auto &cache = _storage->getCache();
-        for (auto &pr : cache) {
-            onRead(pr.second, pr.first);
-        }
+        _storage->for_each([&](const T &data, bool is_key) {
+            onRead(data, is_key);
+        });
     }
 
 private:
+    //直接保存用户回调，避免每个数据包多一层std::function转发
     std::function<void(const T &)> _read_cb = [](const T &) {};
+    std::function<void(const T &, bool)> _read_key_cb;
     std::function<void(void)> _detach_cb = []() {};
     std::shared_ptr<_RingStorage<T>> _storage;
     bool _use_cache;
 };
 
+/**
+ * gop缓存数据节点，写入后只读，由所有poller线程的派发器共享
+ * 节点按写入顺序组成单向链表，派发器只持有gop开始节点与最后节点，
+ * 所以gop缓存只有一份，不随poller线程个数增加
+ * @tparam T
+ */
+template<typename T>
+class _RingNode {
+public:
+    typedef std::shared_ptr<_RingNode> Ptr;
+
+    _RingNode(T data_in, bool is_key_in) : data(std::move(data_in)), is_key(is_key_in) {}
+
+    ~_RingNode() {
+        //循环释放后续节点，防止链表过长时递归析构导致栈溢出
+        auto node = std::move(next);
+        while (node && node.use_count() == 1) {
+            auto tmp = std::move(node->next);
+            node = std::move(tmp);
+        }
+    }
+
+public:
+    const T data;
+    const bool is_key;
+    //在写入线程中赋值一次，派发器切换线程后才能访问到该节点，所以无需加锁
+    Ptr next;
+};
+
+/**
+ * gop缓存视图，只记录gop开始节点与最后写入节点，拷贝代价很小
+ * RingBuffer持有的实例负责生成并链接节点，各派发器持有的实例只跟随移动游标
+ * @tparam T
+ */
 template<typename T>
 class _RingStorage {
 public:
     typedef std::shared_ptr<_RingStorage> Ptr;
+    typedef typename _RingNode<T>::Ptr NodePtr;
 
     _RingStorage(int max_size) {
         //gop缓存个数不能小于32
@@ -121,29 +176,45 @@ public:
     ~_RingStorage() {}
 
     /**
-     * 写入环形缓存数据
+     * 写入环形缓存数据，生成并链接节点
      * @param in 数据
      * @param is_key 是否为关键帧
-     * @return 是否触发重置环形缓存大小
+     * @return 新生成的节点
+     */
+    NodePtr write(T in, bool is_key = true) {
+        auto node = std::make_shared<_RingNode<T> >(std::move(in), is_key);
+        if (_last) {
+            _last->next = node;
+        }
+        write(node);
+        return node;
+    }
+
+    /**
+     * 移动游标到已经链接好的节点
+     * @param node 节点
      */
-     void write(T in, bool is_key = true) {
-        if (is_key && !pre_is_key_) {
+    void write(const NodePtr &node) {
+        _last = node;
+        if (node->is_key && (!pre_is_key_ || !_merge_key)) {
             //遇到I帧，那么移除老数据
             _size = 0;
             _have_idr = true;
-            _data_cache.clear();
+            _gop_head = nullptr;
         }
-        pre_is_key_ = is_key;
+        pre_is_key_ = node->is_key;
         if (!_have_idr) {
             //缓存中没有关键帧，那么gop缓存无效
             return;
         }
-        _data_cache.emplace_back(std::make_pair(is_key, std::move(in)));
+        if (!_gop_head) {
+            _gop_head = node;
+        }
         if (++_size > _max_size) {
             //GOP缓存溢出，清空关老数据
             _size = 0;
             _have_idr = false;
-            _data_cache.clear();
+            _gop_head = nullptr;
         }
     }
 
@@ -152,17 +223,37 @@ public:
         ret->_size = _size;
         ret->_have_idr = _have_idr;
         ret->_max_size = _max_size;
-        ret->_data_cache = _data_cache;
+        ret->_gop_head = _gop_head;
+        ret->_last = _last;
+        ret->pre_is_key_ = pre_is_key_;
+        ret->_merge_key = _merge_key;
         return ret;
     }
 
-    const deque<pair<bool, T>> &getCache() const {
-        return _data_cache;
+    /**
+     * 设置连续的关键帧数据是否合并为同一个gop的开头，默认合并(例如rtp的sps、pps、idr为独立的包)
+     * 每个关键帧数据都是完整gop开头时(例如按gop分片的fmp4)请关闭，否则gop缓存永远不会重置
+     */
+    void setMergeKey(bool merge) {
+        _merge_key = merge;
+    }
+
+    /**
+     * 遍历gop缓存
+     */
+    void for_each(const function<void(const T &data, bool is_key)> &cb) const {
+        for (auto node = _gop_head.get(); node; node = node->next.get()) {
+            cb(node->data, node->is_key);
+            if (node == _last.get()) {
+                //后续节点尚未派发到本线程
+                break;
+            }
+        }
     }
 
     void clearCache(){
         _size = 0;
-        _data_cache.clear(); 
+        _gop_head = nullptr;
     }
 
 private:
@@ -170,10 +261,14 @@ private:
 
 private:
     bool _have_idr = false;
-    std::deque<std::pair<bool, T>> _data_cache;
+    //gop缓存开始节点，没有缓存时为空
+    NodePtr _gop_head;
+    //最后写入的节点
+    NodePtr _last;
     int _max_size;
     int _size = 0;
     bool pre_is_key_ = false;
+    bool _merge_key = true;
 };
 
 template<typename T>
@@ -210,7 +305,7 @@ private:
         _on_size_changed = onSizeChanged;
     }
 
-    void write(T in, bool is_key = true) {
+    void write(const typename RingStorage::NodePtr &node) {
         for (auto it = _reader_map.begin(); it != _reader_map.end();) {
             auto reader = it->second.lock();
             if (!reader) {
@@ -219,10 +314,10 @@ private:
                 onSizeChanged(false);
                 continue;
             }
-            reader->onRead(in, is_key);
+            reader->onRead(node->data, node->is_key);
             ++it;
         }
-        _storage->write(std::move(in), is_key);
+        _storage->write(node);
     }
 
     std::shared_ptr<RingReader> attach(const EventPoller::Ptr &poller, bool use_cache) {
@@ -253,6 +348,10 @@ private:
         _on_size_changed(_reader_size, add_flag);
     }
 
+    int readerCount() const {
+        return _reader_size.load();
+    }
+
     void clearCache(){
         if(_reader_size  == 0){
             _storage->clearCache();
@@ -289,14 +388,23 @@ public:
         }
 
         LOCK_GUARD(_mtx_map);
+        //节点由所有派发器共享，不再每个poller线程各拷贝一份
+        auto node = _storage->write(std::move(in), is_key);
         for (auto &pr : _dispatcher_map) {
             auto &second = pr.second;
             //切换线程后触发onRead事件
-            pr.first->async([second, in, is_key]() {
-                second->write(std::move(const_cast<T &>(in)), is_key);
+            pr.first->async([second, node]() {
+                second->write(node);
             }, false);
         }
-        _storage->write(std::move(in), is_key);
+    }
+
+    /**
+     * 设置连续的关键帧数据是否合并为同一个gop的开头，请在attach之前调用
+     */
+    void setMergeKey(bool merge) {
+        LOCK_GUARD(_mtx_map);
+        _storage->setMergeKey(merge);
     }
 
     void setDelegate(const typename RingDelegate<T>::Ptr &delegate) {
@@ -335,6 +443,34 @@ public:
         return _total_count;
     }
 
+    /**
+     * 获取读取器最多的派发器所在poller线程，
+     * 播放器集中到该poller后，每批数据只需切换一次线程，gop缓存也只需一份
+     * @return 没有读取器时返回空
+     */
+    EventPoller::Ptr getReaderPoller() {
+        LOCK_GUARD(_mtx_map);
+        EventPoller::Ptr ret;
+        int max_size = 0;
+        for (auto &pr : _dispatcher_map) {
+            //读取器个数在各派发器的poller线程中修改
+            int size = pr.second->readerCount();
+            if (size > max_size) {
+                max_size = size;
+                ret = pr.first;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * 遍历写入线程中的gop缓存，请在写入线程中调用
+     */
+    void getCache(const function<void(const T &data, bool is_key)> &cb) {
+        LOCK_GUARD(_mtx_map);
+        _storage->for_each(cb);
+    }
+
     void clearCache(){
         LOCK_GUARD(_mtx_map);
         _storage->clearCache();
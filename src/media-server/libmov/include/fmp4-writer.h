@@ -45,6 +45,16 @@ int fmp4_writer_write(fmp4_writer_t* fmp4, int track, const void* data, size_t b
 /// @return 0-ok, other-error
 int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags, int add_nalu_size);
 
+/// 函数fmp4_writer_write功能差不多，但是不拷贝也不保存sample数据(零拷贝)
+/// 写分片时将以data为NULL、长度为bytes回调mov_buffer_t.write，由调用者自行输出该sample的数据
+/// @param[in] track return by mov_writer_add_audio/mov_writer_add_video
+/// @param[in] bytes sample size, include NALU size
+/// @param[in] pts timestamp in millisecond
+/// @param[in] dts timestamp in millisecond
+/// @param[in] flags MOV_AV_FLAG_XXX, such as: MOV_AV_FLAG_KEYFREAME, see more @mov-format.h
+/// @return 0-ok, other-error
+int fmp4_writer_write_ref(struct fmp4_writer_t* writer, int idx, size_t bytes, int64_t pts, int64_t dts, int flags);
+
 /// Save data and open next segment
 /// @return 0-ok, other-error
 int fmp4_writer_save_segment(fmp4_writer_t* fmp4);
@@ -36,6 +36,8 @@
 /// MOV flags
 #define MOV_FLAG_FASTSTART	0x00000001
 #define MOV_FLAG_SEGMENT	0x00000002 // fmp4_writer only
+#define MOV_FLAG_CACHE		0x00000004 // fmp4_writer only, build boxes in memory and write once per fragment(for memory target)
+#define MOV_FLAG_CMAF		0x00000008 // fmp4_writer with MOV_FLAG_SEGMENT only, CMAF track brands(ISO/IEC 23000-19)
 
 /// MOV av stream flag
 #define MOV_AV_FLAG_KEYFREAME 0x0001
@@ -306,12 +306,23 @@ static int fmp4_write_fragment(struct fmp4_writer_t* writer)
 	}
 	writer->mdat_size = 0;
 
+	mov_buffer_flush(&mov->io);
 	return mov_buffer_error(&mov->io);
 }
 
 static int fmp4_writer_init(struct mov_t* mov)
 {
-	if (mov->flags & MOV_FLAG_SEGMENT)
+	if ((mov->flags & MOV_FLAG_SEGMENT) && (mov->flags & MOV_FLAG_CMAF))
+	{
+		mov->ftyp.major_brand = MOV_BRAND_ISO6;
+		mov->ftyp.minor_version = 0;
+		mov->ftyp.brands_count = 3;
+		mov->ftyp.compatible_brands[0] = MOV_BRAND_ISO6;
+		mov->ftyp.compatible_brands[1] = MOV_BRAND_CMFC;
+		mov->ftyp.compatible_brands[2] = MOV_BRAND_MP41;
+		mov->header = 0;
+	}
+	else if (mov->flags & MOV_FLAG_SEGMENT)
 	{
 		mov->ftyp.major_brand = MOV_BRAND_MSDH;
 		mov->ftyp.minor_version = 0;
@@ -357,6 +368,7 @@ struct fmp4_writer_t* fmp4_writer_create(const struct mov_buffer_t *buffer, void
 
 	mov->io.param = param;
 	memcpy(&mov->io.io, buffer, sizeof(mov->io.io));
+	mov->io.cache_enable = (flags & MOV_FLAG_CACHE) ? 1 : 0;
 	return writer;
 }
 
@@ -372,6 +384,7 @@ void fmp4_writer_destroy(struct fmp4_writer_t* writer)
         mov_free_track(mov->tracks + i);
 	if (mov->tracks)
 		free(mov->tracks);
+	mov_buffer_cache_free(&mov->io);
 	free(writer);
 }
 
@@ -379,18 +392,18 @@ int fmp4_writer_write(struct fmp4_writer_t* writer, int idx, const void* data, s
     return fmp4_writer_write_l(writer, idx, data, bytes, pts, dts, flags, 0);
 }
 
-int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags, int add_nalu_size)
+static struct mov_sample_t* fmp4_writer_add_sample(struct fmp4_writer_t* writer, int idx, size_t bytes, int64_t pts, int64_t dts, int flags, int* r)
 {
     int64_t duration;
 	struct mov_track_t* track;
 	struct mov_sample_t* sample;
 
-	if(add_nalu_size){
-        bytes += 4;
-	}
-
+	*r = 0;
 	if (idx < 0 || idx >= (int)writer->mov.track_count)
-		return -ENOENT;
+	{
+		*r = -ENOENT;
+		return NULL;
+	}
 
 	track = &writer->mov.tracks[idx];
 
@@ -407,7 +420,11 @@ int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data,
 	if (track->sample_count + 1 >= track->sample_offset)
 	{
 		void* ptr = realloc(track->samples, sizeof(struct mov_sample_t) * (track->sample_offset + 1024));
-		if (NULL == ptr) return -ENOMEM;
+		if (NULL == ptr)
+		{
+			*r = -ENOMEM;
+			return NULL;
+		}
 		track->samples = (struct mov_sample_t*)ptr;
 		track->sample_offset += 1024;
 	}
@@ -422,10 +439,37 @@ int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data,
 	sample->pts = pts;
 	sample->dts = dts;
 	sample->offset = writer->mdat_size;
+	sample->data = NULL;
+
+    if (INT64_MIN == track->start_dts)
+        track->start_dts = sample->dts;
+	writer->mdat_size += bytes; // update media data size
+	track->sample_count += 1;
+    track->last_dts = sample->dts;
+	return sample;
+}
+
+int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags, int add_nalu_size)
+{
+	int r;
+	struct mov_sample_t* sample;
+
+	if(add_nalu_size){
+        bytes += 4;
+	}
+
+	sample = fmp4_writer_add_sample(writer, idx, bytes, pts, dts, flags, &r);
+	if (NULL == sample)
+		return r;
 
 	sample->data = malloc(bytes);
 	if (NULL == sample->data)
+	{
+		// rollback
+		writer->mov.tracks[idx].sample_count -= 1;
+		writer->mdat_size -= bytes;
 		return -ENOMEM;
+	}
 
     if (!add_nalu_size) {
         memcpy(sample->data, data, bytes);
@@ -439,15 +483,17 @@ int fmp4_writer_write_l(struct fmp4_writer_t* writer, int idx, const void* data,
         memcpy(sample->data, nalu_size_buf, 4);
         memcpy((char *)sample->data + 4, data, nalu_size);
     }
-
-    if (INT64_MIN == track->start_dts)
-        track->start_dts = sample->dts;
-	writer->mdat_size += bytes; // update media data size
-	track->sample_count += 1;
-    track->last_dts = sample->dts;
 	return 0;
 }
 
+int fmp4_writer_write_ref(struct fmp4_writer_t* writer, int idx, size_t bytes, int64_t pts, int64_t dts, int flags)
+{
+	int r;
+	// sample data is not copied, mov_buffer_t.write is called with NULL data when the fragment is written
+	fmp4_writer_add_sample(writer, idx, bytes, pts, dts, flags, &r);
+	return r;
+}
+
 int fmp4_writer_add_audio(struct fmp4_writer_t* writer, uint8_t object, int channel_count, int bits_per_sample, int sample_rate, const void* extra_data, size_t extra_data_size)
 {
     struct mov_t* mov;
@@ -524,6 +570,7 @@ int fmp4_writer_save_segment(fmp4_writer_t* writer)
 			mov->tracks[i].frag_count = 0; // don't free frags memory
 	}
 
+	mov_buffer_flush(&mov->io);
 	return mov_buffer_error(&mov->io);
 }
 
@@ -533,5 +580,6 @@ int fmp4_writer_init_segment(fmp4_writer_t* writer)
 	mov = &writer->mov;
 	mov_write_ftyp(mov);
 	fmp4_write_moov(mov);
+	mov_buffer_flush(&mov->io);
 	return mov_buffer_error(&mov->io);
 }
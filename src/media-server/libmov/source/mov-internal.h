@@ -83,6 +83,7 @@ enum
 	MOV_BRAND_DASH = MOV_TAG('d', 'a', 's', 'h'), // MPEG-DASH
 	MOV_BRAND_MSDH = MOV_TAG('m', 's', 'd', 'h'), // MPEG-DASH
 	MOV_BRAND_MSIX = MOV_TAG('m', 's', 'i', 'x'), // MPEG-DASH
+	MOV_BRAND_CMFC = MOV_TAG('c', 'm', 'f', 'c'), // CMAF track format
 };
 
 #define MOV_TREX_FLAG_IS_LEADING_MASK					0x0C000000
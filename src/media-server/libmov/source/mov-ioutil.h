@@ -2,12 +2,27 @@
 #define _mov_ioutil_h_
 
 #include "mov-buffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define MOV_CACHE_MIN_CAPACITY	(4 * 1024)
+#define MOV_CACHE_WRITE_THROUGH	(1024) // large sample data bypass cache
 
 struct mov_ioutil_t
 {
 	struct mov_buffer_t io;
 	void* param;
 	int error;
+
+	// write cache(MOV_FLAG_CACHE): box data written into memory, size back-patching in place,
+	// then io.write once on mov_buffer_flush
+	int cache_enable;
+	uint8_t* cache;
+	size_t cache_capacity;
+	size_t cache_bytes; // valid data bytes
+	size_t cache_pos; // write position
+	uint64_t cache_offset; // io offset of cache[0]
 };
 
 static inline int mov_buffer_error(const struct mov_ioutil_t* io)
@@ -15,15 +30,56 @@ static inline int mov_buffer_error(const struct mov_ioutil_t* io)
 	return io->error;
 }
 
+static inline void mov_buffer_flush(const struct mov_ioutil_t* io)
+{
+	struct mov_ioutil_t* w;
+	w = (struct mov_ioutil_t*)io;
+	if (0 == w->cache_bytes)
+		return;
+
+	if (0 == w->error)
+		w->error = w->io.write(w->param, w->cache, w->cache_bytes);
+	if (0 == w->error && w->cache_pos != w->cache_bytes)
+		w->error = w->io.seek(w->param, w->cache_offset + w->cache_pos);
+	w->cache_bytes = 0;
+	w->cache_pos = 0;
+}
+
+static inline void mov_buffer_cache_free(struct mov_ioutil_t* io)
+{
+	if (io->cache)
+		free(io->cache);
+	io->cache = NULL;
+	io->cache_capacity = 0;
+	io->cache_bytes = 0;
+	io->cache_pos = 0;
+}
+
 static inline uint64_t mov_buffer_tell(const struct mov_ioutil_t* io)
 {
+	if (io->cache_bytes > 0)
+		return io->cache_offset + io->cache_pos;
 	return io->io.tell(io->param);
 }
 
 static inline void mov_buffer_seek(const struct mov_ioutil_t* io, uint64_t offset)
 {
+	struct mov_ioutil_t* w;
+	w = (struct mov_ioutil_t*)io;
+	if (w->cache_bytes > 0)
+	{
+		if (offset >= w->cache_offset && offset <= w->cache_offset + w->cache_bytes)
+		{
+			// seek in cache
+			w->cache_pos = (size_t)(offset - w->cache_offset);
+			w->error = 0;
+			return;
+		}
+		mov_buffer_flush(w);
+	}
+
 //	if (0 == io->error)
-		((struct mov_ioutil_t*)io)->error = io->io.seek(io->param, offset);
+		w->error = w->io.seek(w->param, offset);
 }
 
 static inline void mov_buffer_skip(struct mov_ioutil_t* io, uint64_t bytes)
@@ -31,8 +87,8 @@ static inline void mov_buffer_skip(struct mov_ioutil_t* io, uint64_t bytes)
 	uint64_t offset;
 	if (0 == io->error)
 	{
-		offset = io->io.tell(io->param);
-		io->error = io->io.seek(io->param, offset + bytes);
+		offset = mov_buffer_tell(io);
+		mov_buffer_seek(io, offset + bytes);
 	}
 }
 
@@ -42,10 +98,51 @@ static inline void mov_buffer_read(struct mov_ioutil_t* io, void* data, uint64_t
 		io->error = io->io.read(io->param, data, bytes);
 }
 
+static inline int mov_buffer_cache_write(struct mov_ioutil_t* io, const void* data, size_t bytes)
+{
+	void* p;
+	size_t capacity;
+	if (io->cache_pos + bytes > io->cache_capacity)
+	{
+		capacity = io->cache_capacity > MOV_CACHE_MIN_CAPACITY ? io->cache_capacity : MOV_CACHE_MIN_CAPACITY;
+		while (capacity < io->cache_pos + bytes)
+			capacity *= 2;
+		p = realloc(io->cache, capacity);
+		if (NULL == p)
+			return -ENOMEM;
+		io->cache = (uint8_t*)p;
+		io->cache_capacity = capacity;
+	}
+
+	if (0 == io->cache_bytes)
+		io->cache_offset = io->io.tell(io->param);
+	memcpy(io->cache + io->cache_pos, data, bytes);
+	io->cache_pos += bytes;
+	if (io->cache_pos > io->cache_bytes)
+		io->cache_bytes = io->cache_pos;
+	return 0;
+}
+
 static inline void mov_buffer_write(const struct mov_ioutil_t* io, const void* data, uint64_t bytes)
 {
-	if (0 == io->error)
-		((struct mov_ioutil_t*)io)->error = io->io.write(io->param, data, bytes);
+	struct mov_ioutil_t* w;
+	w = (struct mov_ioutil_t*)io;
+	if (0 != w->error)
+		return;
+
+	if (w->cache_enable)
+	{
+		// data == NULL: sample data referenced by io.write, keep order with cached box data
+		if (data && (bytes < MOV_CACHE_WRITE_THROUGH || w->cache_pos != w->cache_bytes))
+		{
+			w->error = mov_buffer_cache_write(w, data, (size_t)bytes);
+			return;
+		}
+		mov_buffer_flush(w);
+		if (0 != w->error)
+			return;
+	}
+	w->error = w->io.write(w->param, data, bytes);
 }
 
 static inline uint8_t mov_buffer_r8(struct mov_ioutil_t* io)
@@ -94,26 +191,43 @@ static inline void mov_buffer_w8(const struct mov_ioutil_t* io, uint8_t v)
 
 static inline void mov_buffer_w16(const struct mov_ioutil_t* io, uint16_t v)
 {
-	mov_buffer_w8(io, (uint8_t)(v >> 8));
-	mov_buffer_w8(io, (uint8_t)v);
+	uint8_t p[2];
+	p[0] = (uint8_t)(v >> 8);
+	p[1] = (uint8_t)v;
+	mov_buffer_write(io, p, 2);
 }
 
 static inline void mov_buffer_w24(const struct mov_ioutil_t* io, uint32_t v)
 {
-	mov_buffer_w16(io, (uint16_t)(v >> 8));
-	mov_buffer_w8(io, (uint8_t)v);
+	uint8_t p[3];
+	p[0] = (uint8_t)(v >> 16);
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)v;
+	mov_buffer_write(io, p, 3);
 }
 
 static inline void mov_buffer_w32(const struct mov_ioutil_t* io, uint32_t v)
 {
-	mov_buffer_w16(io, (uint16_t)(v >> 16));
-	mov_buffer_w16(io, (uint16_t)v);
+	uint8_t p[4];
+	p[0] = (uint8_t)(v >> 24);
+	p[1] = (uint8_t)(v >> 16);
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)v;
+	mov_buffer_write(io, p, 4);
 }
 
 static inline void mov_buffer_w64(const struct mov_ioutil_t* io, uint64_t v)
 {
-	mov_buffer_w32(io, (uint32_t)(v >> 32));
-	mov_buffer_w32(io, (uint32_t)v);
+	uint8_t p[8];
+	p[0] = (uint8_t)(v >> 56);
+	p[1] = (uint8_t)(v >> 48);
+	p[2] = (uint8_t)(v >> 40);
+	p[3] = (uint8_t)(v >> 32);
+	p[4] = (uint8_t)(v >> 24);
+	p[5] = (uint8_t)(v >> 16);
+	p[6] = (uint8_t)(v >> 8);
+	p[7] = (uint8_t)v;
+	mov_buffer_write(io, p, 8);
 }
 
 #endif /* !_mov_ioutil_h_ */
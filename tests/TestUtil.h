@@ -0,0 +1,80 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef ZLMEDIAKIT_TESTUTIL_H
+#define ZLMEDIAKIT_TESTUTIL_H
+
+#include <string>
+#include "Extension/H264.h"
+
+namespace mediakit {
+namespace test {
+
+//测试用gop帧率，每秒一个gop
+static const int kFps = 25;
+
+static inline std::string hexToBytes(const char *str) {
+    std::string ret;
+    for (; *str; str += 2) {
+        ret.push_back((char) strtol(std::string(str, 2).data(), nullptr, 16));
+    }
+    return ret;
+}
+
+//640x480的h264 sps
+static inline std::string testSps() {
+    return hexToBytes("6764001facd9405005bb011000000300100000030320f1831960");
+}
+
+static inline std::string testPps() {
+    return hexToBytes("68ebe3cb22c0");
+}
+
+static inline H264Track::Ptr makeH264Track() {
+    return std::make_shared<H264Track>(testSps(), testPps(), 0, 0);
+}
+
+/**
+ * 生成带4字节start code的h264帧
+ * @param nalu 不含start code的nalu
+ * @param stamp 时间戳(毫秒)
+ */
+static inline Frame::Ptr makeFrame(const std::string &nalu, uint32_t stamp) {
+    auto frame = std::make_shared<H264Frame>();
+    frame->_buffer.assign("\x00\x00\x00\x01", 4);
+    frame->_buffer.append(nalu);
+    frame->_dts = frame->_pts = stamp;
+    frame->_prefix_size = 4;
+    return frame;
+}
+
+/**
+ * 输入一个gop：sps、pps、idr加上kFps - 1个p帧，帧间隔40ms
+ * @param writer 支持inputFrame的对象
+ * @param index 帧序号，用于计算时间戳，输入后递增
+ */
+template<typename WRITER>
+void inputGop(WRITER &&writer, int &index) {
+    static auto sps = testSps();
+    static auto pps = testPps();
+    for (int i = 0; i < kFps; ++i, ++index) {
+        if (i == 0) {
+            writer->inputFrame(makeFrame(sps, index * 40));
+            writer->inputFrame(makeFrame(pps, index * 40));
+            writer->inputFrame(makeFrame(std::string("\x65", 1) + std::string(1000, 'k'), index * 40));
+        } else {
+            writer->inputFrame(makeFrame(std::string("\x41", 1) + std::string(100, 'p'), index * 40));
+        }
+    }
+}
+
+}//namespace test
+}//namespace mediakit
+#endif //ZLMEDIAKIT_TESTUTIL_H
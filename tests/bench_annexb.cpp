@@ -0,0 +1,161 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "Extension/AnnexB.h"
+#include "Extension/H265.h"
+#include "Util/TimeTicker.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+
+//旧版逐字节memcmp查找，用于对比
+static const char *memfind(const char *buf, int len, const char *subbuf, int sublen) {
+    for (auto i = 0; i < len - sublen; ++i) {
+        if (memcmp(buf + i, subbuf, sublen) == 0) {
+            return buf + i;
+        }
+    }
+    return nullptr;
+}
+
+//统计start code个数
+template<typename FIND>
+static int countStartCode(const vector<string> &frames, FIND &&find) {
+    int count = 0;
+    for (auto &data : frames) {
+        auto ptr = data.data();
+        auto end = data.data() + data.size();
+        while ((ptr = find(ptr, end))) {
+            ++count;
+            ptr += 3;
+        }
+    }
+    return count;
+}
+
+//返回吞吐量(GB/s)
+template<typename FIND>
+static double benchFind(const vector<string> &frames, int loop, FIND &&find, int &count) {
+    size_t bytes = 0;
+    for (auto &data : frames) {
+        bytes += data.size();
+    }
+    Ticker ticker;
+    for (int i = 0; i < loop; ++i) {
+        count = countStartCode(frames, find);
+    }
+    auto ms = std::max<uint64_t>(ticker.elapsedTime(), 1);
+    return (double) bytes * loop / ms / 1000000.0;
+}
+
+static bool bench(const string &name, const vector<string> &frames, int loop) {
+    auto old_find = [](const char *ptr, const char *end) {
+        return memfind(ptr, end - ptr, "\x00\x00\x01", 3);
+    };
+    auto new_find = [](const char *ptr, const char *end) {
+        return findStartCode(ptr, end);
+    };
+    int old_count, new_count;
+    auto old_speed = benchFind(frames, loop, old_find, old_count);
+    auto new_speed = benchFind(frames, loop, new_find, new_count);
+    cout << name << ": memfind " << old_speed << " GB/s, findStartCode " << new_speed << " GB/s, start code "
+         << old_count << "/" << new_count << (old_count == new_count ? "" : " mismatch!") << endl;
+    return old_count == new_count;
+}
+
+static bool endWith(const string &str, const string &suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * 从annexb裸流文件中提取所有idr帧，同一帧的多个idr slice合并为一帧(包含start code)
+ * @param path 文件路径，.h265/.265/.hevc后缀按h265解析，否则按h264解析
+ */
+static vector<string> loadIdrFrames(const string &path) {
+    vector<string> frames;
+    ifstream file(path, ios::binary);
+    if (!file) {
+        cerr << "open file failed:" << path << endl;
+        return frames;
+    }
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    auto is_h265 = endWith(path, ".h265") || endWith(path, ".265") || endWith(path, ".hevc");
+    auto prefix = prefixSize(data.data(), data.size());
+    if (!prefix) {
+        cerr << "not annexb file:" << path << endl;
+        return frames;
+    }
+    bool last_is_idr = false;
+    splitAnnexB(data.data(), data.size(), prefix, [&](const char *ptr, int len, int prefix) {
+        if (len <= prefix) {
+            return;
+        }
+        auto header = (uint8_t) ptr[prefix];
+        auto is_idr = is_h265 ? H265Frame::isKeyFrame(H265_TYPE(header)) : H264_TYPE(header) == H264Frame::NAL_IDR;
+        if (is_idr) {
+            if (!last_is_idr) {
+                frames.emplace_back();
+            }
+            frames.back().append(ptr, len);
+        }
+        last_is_idr = is_idr;
+    });
+    return frames;
+}
+
+/**
+ * 用法: bench_annexb [annexb文件]
+ * 指定文件(例如4K h264/h265裸流)时测试其中的idr帧，否则使用随机生成的数据
+ */
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        auto frames = loadIdrFrames(argv[1]);
+        if (frames.empty()) {
+            cerr << "no idr frame found:" << argv[1] << endl;
+            return -1;
+        }
+        size_t bytes = 0;
+        for (auto &frame : frames) {
+            bytes += frame.size();
+        }
+        //每轮至少扫描约256MB数据
+        auto loop = std::max<size_t>(1, (256 << 20) / bytes);
+        auto name = to_string(frames.size()) + " idr frames(avg " + to_string(bytes / frames.size() / 1024) + "KB)";
+        return bench(name, frames, loop) ? 0 : -1;
+    }
+
+    mt19937 rng(0);
+    //不含start code的8MB数据
+    string no_start_code(8 * 1024 * 1024, '\0');
+    for (auto &ch : no_start_code) {
+        ch = (char) (rng() % 255 + 1);
+    }
+
+    //模拟视频帧：每个nalu 1KB到64KB，nalu内部随机包含0x00
+    string frames;
+    while (frames.size() < 8 * 1024 * 1024) {
+        frames.append("\x00\x00\x00\x01", 4);
+        auto nalu_size = 1024 + rng() % (63 * 1024);
+        for (size_t i = 0; i < nalu_size; ++i) {
+            auto val = rng() % 256;
+            frames.push_back((char) (val < 16 ? 0 : (val == 16 ? 3 : val)));
+        }
+        //nalu末尾不能以00结束
+        frames.back() = 0x55;
+    }
+
+    bool ok = bench("no start code", {no_start_code}, 4);
+    ok = bench("annexb frames", {frames}, 4) && ok;
+    return ok ? 0 : -1;
+}
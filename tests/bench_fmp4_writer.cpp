@@ -0,0 +1,161 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iostream>
+#include <vector>
+#include "Http/MP4.h"
+#include "Util/TimeTicker.h"
+#include "TestUtil.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+using namespace mediakit::test;
+
+//1080p/25fps约4Mbps的h264直播流：每2秒一个约150KB的idr帧，其余为约17KB的p帧
+static const int kWriters = 500;
+static const int kFrames = 250;
+static const int kGopFrames = 50;
+static const size_t kIdrBytes = 150 * 1024;
+static const size_t kPBytes = 17 * 1024;
+
+/**
+ * 一路fmp4直播复用器，每帧输出一个分片(moof+mdat)，与FMP4MediaSourceMuxer默认分片策略相同
+ */
+class FMP4Writer {
+public:
+    FMP4Writer(bool cache) {
+        _file = std::make_shared<MP4FileMemory>();
+        _writer = _file->createWriter(MOV_FLAG_SEGMENT | (cache ? MOV_FLAG_CACHE : 0), true);
+
+        struct mpeg4_avc_t avc = {0};
+        string sps_pps = string("\x00\x00\x00\x01", 4) + testSps() + string("\x00\x00\x00\x01", 4) + testPps();
+        h264_annexbtomp4(&avc, sps_pps.data(), sps_pps.size(), NULL, 0, NULL, NULL);
+        uint8_t extra_data[1024];
+        int extra_data_size = mpeg4_avc_decoder_configuration_record_save(&avc, extra_data, sizeof(extra_data));
+        _track_id = mp4_writer_add_video(_writer.get(), MOV_OBJECT_H264, 1920, 1080, extra_data, extra_data_size);
+        mp4_writer_init_segment(_writer.get());
+        mp4_writer_save_segment(_writer.get());
+        _init_segment = _file->getAndClearMemory();
+    }
+
+    /**
+     * 写入一帧并输出分片
+     * @param payload mp4格式的帧(4字节nalu长度+nalu)
+     * @param zero_copy 是否以引用方式写入sample
+     */
+    List<Buffer::Ptr> write(const Buffer::Ptr &payload, int index, bool zero_copy) {
+        int64_t stamp = index * 40;
+        int flags = index % kGopFrames == 0 ? MOV_AV_FLAG_KEYFREAME : 0;
+        if (zero_copy) {
+            _file->addSampleRef(payload);
+            mp4_writer_write_ref(_writer.get(), _track_id, payload->size(), stamp, stamp, flags);
+        } else {
+            mp4_writer_write(_writer.get(), _track_id, payload->data(), payload->size(), stamp, stamp, flags);
+        }
+        mp4_writer_save_segment(_writer.get());
+        return _file->getAndClearBuffers();
+    }
+
+    const string &getInitSegment() const {
+        return _init_segment;
+    }
+
+private:
+    int _track_id;
+    string _init_segment;
+    MP4FileMemory::Ptr _file;
+    MP4FileIO::Writer _writer;
+};
+
+static Buffer::Ptr makePayload(uint8_t nalu_header, size_t bytes) {
+    string payload(bytes, '\0');
+    uint32_t nalu_size = htonl(bytes - 4);
+    memcpy(&payload[0], &nalu_size, 4);
+    payload[4] = (char) nalu_header;
+    for (size_t i = 5; i < bytes; ++i) {
+        payload[i] = (char) (i * 131 + 7);
+    }
+    return std::make_shared<BufferString>(std::move(payload));
+}
+
+static string toString(List<Buffer::Ptr> buffers) {
+    string ret;
+    buffers.for_each([&](const Buffer::Ptr &buf) {
+        ret.append(buf->data(), buf->size());
+    });
+    return ret;
+}
+
+//所有播放器共享同一帧数据，与直播一致
+static Buffer::Ptr s_idr = makePayload(0x65, kIdrBytes);
+static Buffer::Ptr s_p = makePayload(0x41, kPBytes);
+
+static const Buffer::Ptr &payloadOf(int index) {
+    return index % kGopFrames == 0 ? s_idr : s_p;
+}
+
+/**
+ * kWriters路复用器轮流写入kFrames帧
+ * @return 每秒输出的分片个数
+ */
+static double benchWriters(bool cache, bool zero_copy) {
+    vector<std::shared_ptr<FMP4Writer> > writers;
+    for (int i = 0; i < kWriters; ++i) {
+        writers.emplace_back(std::make_shared<FMP4Writer>(cache));
+    }
+    size_t bytes = 0;
+    Ticker ticker;
+    for (int index = 0; index < kFrames; ++index) {
+        for (auto &writer : writers) {
+            writer->write(payloadOf(index), index, zero_copy).for_each([&](const Buffer::Ptr &buf) {
+                bytes += buf->size();
+            });
+        }
+    }
+    auto ms = std::max<uint64_t>(ticker.elapsedTime(), 1);
+    return (double) kWriters * kFrames * 1000 / ms;
+}
+
+/**
+ * 检查开启与关闭MOV_FLAG_CACHE时输出完全一致
+ */
+static bool checkIdentical(bool zero_copy) {
+    FMP4Writer cached(true), uncached(false);
+    if (cached.getInitSegment() != uncached.getInitSegment()) {
+        cout << "init segment mismatch" << endl;
+        return false;
+    }
+    for (int index = 0; index < kFrames; ++index) {
+        if (toString(cached.write(payloadOf(index), index, zero_copy)) != toString(uncached.write(payloadOf(index), index, zero_copy))) {
+            cout << "fragment mismatch at frame " << index << ", zero copy:" << zero_copy << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (!checkIdentical(true) || !checkIdentical(false)) {
+        return -1;
+    }
+    cout << "output identical with and without MOV_FLAG_CACHE" << endl;
+
+    //实时需要的分片速率
+    auto realtime = kWriters * 25.0;
+    cout << kWriters << " writers x " << kFrames << " frames(1080p/25fps), realtime needs " << realtime << " fragments/s" << endl;
+    for (auto zero_copy : {true, false}) {
+        auto uncached = benchWriters(false, zero_copy);
+        auto cached = benchWriters(true, zero_copy);
+        cout << (zero_copy ? "zero copy" : "copy") << " path: without cache " << uncached << " fragments/s("
+             << realtime * 100 / uncached << "% of a core), with cache " << cached << " fragments/s("
+             << realtime * 100 / cached << "% of a core)" << endl;
+    }
+    return 0;
+}
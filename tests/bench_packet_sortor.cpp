@@ -0,0 +1,204 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <map>
+#include <iostream>
+#include <random>
+#include "Rtsp/RtpReceiver.h"
+#include "Util/TimeTicker.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+
+/**
+ * 旧版基于std::map的rtp排序器，用于对比
+ */
+template<typename T, typename SEQ = uint16_t, uint32_t kMax = 256, uint32_t kMin = 64>
+class MapPacketSortor {
+public:
+    void setOnSort(function<void(SEQ seq, T &packet)> cb) {
+        _cb = std::move(cb);
+    }
+
+    void sortPacket(SEQ seq, T packet) {
+        if (seq < _next_seq_out) {
+            if (_next_seq_out - seq < kMax) {
+                //过滤seq回退包(回环包除外)
+                return;
+            }
+        } else if (_next_seq_out && seq - _next_seq_out > (0xFFFF >> 1)) {
+            //过滤seq跳变非常大的包(防止回环时乱序时收到非常大的seq)
+            return;
+        }
+        _rtp_sort_cache_map.emplace(seq, std::move(packet));
+        tryPopPacket();
+    }
+
+private:
+    void popPacket() {
+        auto it = _rtp_sort_cache_map.begin();
+        if (it->first >= _next_seq_out) {
+            popIterator(it);
+            return;
+        }
+        if (_next_seq_out - it->first > (0xFFFF >> 1)) {
+            //产生回环了
+            if (_rtp_sort_cache_map.size() < 2 * kMin) {
+                return;
+            }
+            auto hit = _rtp_sort_cache_map.upper_bound((SEQ) (_next_seq_out - _rtp_sort_cache_map.size()));
+            while (hit != _rtp_sort_cache_map.end()) {
+                _cb(hit->first, hit->second);
+                hit = _rtp_sort_cache_map.erase(hit);
+            }
+            popIterator(_rtp_sort_cache_map.begin());
+            return;
+        }
+        _rtp_sort_cache_map.erase(it);
+    }
+
+    void popIterator(typename map<SEQ, T>::iterator it) {
+        auto seq = it->first;
+        auto data = std::move(it->second);
+        _rtp_sort_cache_map.erase(it);
+        _next_seq_out = seq + 1;
+        _cb(seq, data);
+    }
+
+    void tryPopPacket() {
+        int count = 0;
+        while ((!_rtp_sort_cache_map.empty() && _rtp_sort_cache_map.begin()->first == _next_seq_out)) {
+            popPacket();
+            ++count;
+        }
+        if (count) {
+            setSortSize();
+        } else if (_rtp_sort_cache_map.size() > _max_sort_size) {
+            popPacket();
+            setSortSize();
+        }
+    }
+
+    void setSortSize() {
+        _max_sort_size = kMin + _rtp_sort_cache_map.size();
+        if (_max_sort_size > kMax) {
+            _max_sort_size = kMax;
+        }
+    }
+
+private:
+    SEQ _next_seq_out = 0;
+    uint32_t _max_sort_size = kMin;
+    map<SEQ, T> _rtp_sort_cache_map;
+    function<void(SEQ seq, T &packet)> _cb;
+};
+
+using PacketPtr = std::shared_ptr<int>;
+
+/**
+ * 生成seq序列，会多次回环
+ * @param count 包个数
+ * @param reorder_percent 与后面几个包交换位置的包的百分比
+ */
+static vector<uint16_t> makeSeqs(int count, int reorder_percent) {
+    mt19937 rng(0);
+    vector<uint16_t> seqs(count);
+    for (int i = 0; i < count; ++i) {
+        seqs[i] = (uint16_t) i;
+    }
+    for (int i = 0; i + 8 < count; ++i) {
+        if ((int) (rng() % 100) < reorder_percent) {
+            swap(seqs[i], seqs[i + 1 + rng() % 8]);
+        }
+    }
+    return seqs;
+}
+
+//返回每个包的耗时(ns)
+template<typename SORTOR>
+static double benchSort(const vector<uint16_t> &seqs, int &out_count) {
+    SORTOR sortor;
+    out_count = 0;
+    sortor.setOnSort([&](uint16_t seq, PacketPtr &packet) {
+        ++out_count;
+    });
+    auto packet = std::make_shared<int>(0);
+    Ticker ticker;
+    for (auto seq : seqs) {
+        sortor.sortPacket(seq, packet);
+    }
+    return ticker.elapsedTime() * 1000000.0 / seqs.size();
+}
+
+/**
+ * 单个seq向前跳变超过一半seq空间的异常包应被丢弃，不能清空排序缓存或者移动排序窗口
+ */
+static bool checkStrayPacket() {
+    PacketSortor<PacketPtr> sortor;
+    vector<uint16_t> out;
+    sortor.setOnSort([&](uint16_t seq, PacketPtr &packet) {
+        out.emplace_back(seq);
+    });
+    auto packet = std::make_shared<int>(0);
+    //1000与1001乱序，异常包夹在中间
+    for (uint16_t seq : {998, 999, 1001}) {
+        sortor.sortPacket(seq, packet);
+    }
+    sortor.sortPacket(1001 + 0x8000, packet);
+    for (uint16_t seq = 1000; seq < 1100; ++seq) {
+        if (seq != 1001) {
+            sortor.sortPacket(seq, packet);
+        }
+    }
+    bool ok = out.size() == 102;
+    for (size_t i = 0; ok && i < out.size(); ++i) {
+        ok = out[i] == 998 + i;
+    }
+    cout << "stray packet check: " << (ok ? "passed" : "failed") << endl;
+    return ok;
+}
+
+/**
+ * seq跳变(>= kMax)并越过回环点时也要计入回环次数
+ */
+static bool checkJumpCycle() {
+    PacketSortor<PacketPtr> sortor;
+    uint32_t count = 0;
+    sortor.setOnSort([&](uint16_t seq, PacketPtr &packet) {
+        ++count;
+    });
+    auto packet = std::make_shared<int>(0);
+    for (uint32_t seq = 65000; seq < 65100; ++seq) {
+        sortor.sortPacket((uint16_t) seq, packet);
+    }
+    //跳过536个seq，越过回环点
+    for (uint16_t seq = 100; seq < 200; ++seq) {
+        sortor.sortPacket(seq, packet);
+    }
+    bool ok = count == 200 && sortor.getCycleCount() == 1;
+    cout << "jump across wraparound check: " << (ok ? "passed" : "failed") << ", cycle:" << sortor.getCycleCount() << endl;
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    if (!checkStrayPacket() || !checkJumpCycle()) {
+        return -1;
+    }
+    static const int kCount = 4 * 1000 * 1000;
+    for (auto reorder : {0, 2, 20}) {
+        auto seqs = makeSeqs(kCount, reorder);
+        int map_out, ring_out;
+        auto map_ns = benchSort<MapPacketSortor<PacketPtr> >(seqs, map_out);
+        auto ring_ns = benchSort<PacketSortor<PacketPtr> >(seqs, ring_out);
+        cout << "reorder " << reorder << "%: map " << map_ns << " ns/packet(" << map_out << " out), ring "
+             << ring_ns << " ns/packet(" << ring_out << " out)" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iostream>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include "Util/ResourcePool.h"
+#include "Util/TimeTicker.h"
+using namespace std;
+using namespace toolkit;
+
+//大小与RtpPacket相近的对象
+struct PoolObject {
+    char data[1500];
+};
+
+/**
+ * 旧版循环池实现，用于对比：每次获取都加锁，并且额外分配退出标记与带捕获删除器的控制块
+ */
+class MutexPool : public enable_shared_from_this<MutexPool> {
+public:
+    shared_ptr<PoolObject> obtain() {
+        PoolObject *ptr;
+        {
+            lock_guard<mutex> lck(_mutex);
+            if (_objs.empty()) {
+                ptr = new PoolObject;
+            } else {
+                ptr = _objs.front();
+                _objs.pop_front();
+            }
+        }
+        weak_ptr<MutexPool> weak_pool = shared_from_this();
+        auto quit = std::make_shared<atomic_bool>(false);
+        return shared_ptr<PoolObject>(ptr, [weak_pool, quit](PoolObject *ptr) {
+            auto strong_pool = weak_pool.lock();
+            if (strong_pool && !(*quit)) {
+                strong_pool->recycle(ptr);
+            } else {
+                delete ptr;
+            }
+        });
+    }
+
+    ~MutexPool() {
+        _objs.for_each([](PoolObject *ptr) {
+            delete ptr;
+        });
+    }
+
+private:
+    void recycle(PoolObject *ptr) {
+        lock_guard<mutex> lck(_mutex);
+        if (_objs.size() >= 8) {
+            delete ptr;
+            return;
+        }
+        _objs.emplace_back(ptr);
+    }
+
+private:
+    mutex _mutex;
+    List<PoolObject *> _objs;
+};
+
+static const int kLoop = 2000000;
+static const int kBatch = 64;
+
+//同一线程获取并释放
+template<typename Obtain>
+static double benchSameThread(Obtain &&obtain) {
+    Ticker ticker;
+    for (int i = 0; i < kLoop; ++i) {
+        auto obj = obtain();
+        obj->data[0] = (char) i;
+    }
+    return ticker.elapsedTime() * 1000000.0 / kLoop;
+}
+
+//本线程获取，另外一个线程释放
+template<typename Obtain>
+static double benchCrossThread(Obtain &&obtain) {
+    using Batch = vector<decltype(obtain())>;
+    mutex mtx;
+    condition_variable cond;
+    List<Batch> batches;
+    bool exit_flag = false;
+    thread releaser([&]() {
+        while (true) {
+            Batch batch;
+            {
+                unique_lock<mutex> lck(mtx);
+                cond.wait(lck, [&]() { return exit_flag || !batches.empty(); });
+                if (batches.empty()) {
+                    break;
+                }
+                batch = std::move(batches.front());
+                batches.pop_front();
+            }
+            //在本线程释放对象
+            batch.clear();
+        }
+    });
+
+    Ticker ticker;
+    for (int i = 0; i < kLoop / kBatch; ++i) {
+        Batch batch;
+        batch.reserve(kBatch);
+        for (int j = 0; j < kBatch; ++j) {
+            batch.emplace_back(obtain());
+        }
+        {
+            lock_guard<mutex> lck(mtx);
+            batches.emplace_back(std::move(batch));
+        }
+        cond.notify_one();
+    }
+    {
+        lock_guard<mutex> lck(mtx);
+        exit_flag = true;
+    }
+    cond.notify_one();
+    releaser.join();
+    return ticker.elapsedTime() * 1000000.0 / kLoop;
+}
+
+int main(int argc, char *argv[]) {
+    auto mutex_pool = std::make_shared<MutexPool>();
+    ResourcePool<PoolObject> pool;
+    pool.setSize(kBatch * 4);
+
+    auto mutex_obtain = [&]() { return mutex_pool->obtain(); };
+    auto pool_obtain = [&]() { return pool.obtain(); };
+
+    cout << "same thread obtain+release(ns/op): mutex pool " << benchSameThread(mutex_obtain)
+         << ", ResourcePool " << benchSameThread(pool_obtain) << endl;
+    cout << "cross thread obtain+release(ns/op): mutex pool " << benchCrossThread(mutex_obtain)
+         << ", ResourcePool " << benchCrossThread(pool_obtain) << endl;
+    return 0;
+}
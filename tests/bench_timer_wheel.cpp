@@ -0,0 +1,98 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <map>
+#include <set>
+#include <iostream>
+#include <random>
+#include "Poller/TimerWheel.h"
+#include "Util/TimeTicker.h"
+using namespace std;
+using namespace toolkit;
+
+static const int kTimerCount = 100000;
+static const uint64_t kSpanMS = 60 * 1000;
+
+int main(int argc, char *argv[]) {
+    mt19937_64 rng(0);
+    vector<uint64_t> expires(kTimerCount);
+    for (auto &expire : expires) {
+        expire = rng() % kSpanMS;
+    }
+
+    //旧版EventPoller使用的multimap
+    multimap<uint64_t, uint64_t> delay_map;
+    TimerWheel<uint64_t> wheel(0);
+
+    Ticker ticker;
+    for (int i = 0; i < kTimerCount; ++i) {
+        delay_map.emplace(expires[i], i);
+    }
+    auto map_insert_ms = ticker.elapsedTime();
+
+    ticker.resetTime();
+    for (int i = 0; i < kTimerCount; ++i) {
+        wheel.add(expires[i], i);
+    }
+    auto wheel_insert_ms = ticker.elapsedTime();
+
+    //按毫秒推进时间，取出所有到期定时器
+    ticker.resetTime();
+    uint64_t map_expired = 0;
+    for (uint64_t now = 0; now <= kSpanMS; ++now) {
+        while (!delay_map.empty() && delay_map.begin()->first <= now) {
+            delay_map.erase(delay_map.begin());
+            ++map_expired;
+        }
+    }
+    auto map_expire_ms = ticker.elapsedTime();
+
+    ticker.resetTime();
+    uint64_t wheel_expired = 0;
+    vector<uint64_t> out;
+    for (uint64_t now = 0; now <= kSpanMS; ++now) {
+        out.clear();
+        wheel.expire(now, out);
+        wheel_expired += out.size();
+    }
+    auto wheel_expire_ms = ticker.elapsedTime();
+
+    cout << kTimerCount << " timers over " << kSpanMS << "ms" << endl;
+    cout << "insert(ms): multimap " << map_insert_ms << ", TimerWheel " << wheel_insert_ms << endl;
+    cout << "expire(ms): multimap " << map_expire_ms << "(" << map_expired << "), TimerWheel " << wheel_expire_ms
+         << "(" << wheel_expired << ")" << endl;
+
+    //随机步长推进并交叉添加定时器，校验每一步到期的定时器集合与multimap一致
+    TimerWheel<uint64_t> check_wheel(0);
+    uint64_t now = 0;
+    uint64_t id = 0;
+    for (int step = 0; step < 20000; ++step) {
+        for (int i = rng() % 8; i > 0; --i) {
+            //包括超过时间轮范围的超长定时器
+            auto expire = now + (rng() % 16 == 0 ? rng() % (100ULL * 3600 * 1000) : rng() % 5000);
+            delay_map.emplace(expire, id);
+            check_wheel.add(expire, id++);
+        }
+        now += rng() % 2000;
+        set<uint64_t> expected;
+        while (!delay_map.empty() && delay_map.begin()->first <= now) {
+            expected.emplace(delay_map.begin()->second);
+            delay_map.erase(delay_map.begin());
+        }
+        out.clear();
+        check_wheel.expire(now, out);
+        if (set<uint64_t>(out.begin(), out.end()) != expected) {
+            cout << "expire set mismatch at " << now << "ms" << endl;
+            return -1;
+        }
+    }
+    cout << "randomized check against multimap passed" << endl;
+    return 0;
+}
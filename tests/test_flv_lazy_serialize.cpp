@@ -0,0 +1,69 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iostream>
+#include "Rtmp/RtmpMediaSourceMuxer.h"
+#include "Poller/EventPoller.h"
+#include "TestUtil.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+using namespace mediakit::test;
+
+/**
+ * 没有http-flv播放器时不序列化flv，第一个播放器加入后从rtmp的gop缓存补齐
+ */
+int main() {
+    auto muxer = std::make_shared<RtmpMediaSourceMuxer>(DEFAULT_VHOST, "live", "lazy_flv", std::make_shared<TitleMeta>(0));
+    muxer->addTrack(makeH264Track());
+    muxer->onAllTrackReady();
+    int index = 0;
+    inputGop(muxer, index);
+    inputGop(muxer, index);
+
+    auto src = dynamic_pointer_cast<RtmpMediaSource>(MediaSource::find(RTMP_SCHEMA, DEFAULT_VHOST, "live", "lazy_flv"));
+    if (!src) {
+        cerr << "rtmp source not found" << endl;
+        return 1;
+    }
+    int rtmp_gop = 0;
+    src->getRing()->getCache([&](const RtmpMediaSource::RingDataType &, bool) {
+        ++rtmp_gop;
+    });
+    int flv_cached = 0;
+    src->getFlvRing()->getCache([&](const RtmpMediaSource::FlvRingDataType &, bool) {
+        ++flv_cached;
+    });
+
+    int flv_packets = 0;
+    bool first_key = false;
+    auto poller = EventPollerPool::Instance().getPoller();
+    RtmpMediaSource::FlvRingType::RingReader::Ptr reader;
+    poller->sync([&]() {
+        reader = src->getFlvRing()->attach(poller);
+        reader->setReadKeyCB([&](const RtmpMediaSource::FlvRingDataType &, bool is_key) {
+            if (!flv_packets) {
+                first_key = is_key;
+            }
+            ++flv_packets;
+        });
+    });
+    //播放器加入后的下一批数据
+    inputGop(muxer, index);
+    //在poller线程释放读取器，避免退出时其回调仍引用本函数的局部变量
+    poller->sync([&]() {
+        reader = nullptr;
+    });
+
+    cout << "flv cached without reader:" << flv_cached << ", rtmp gop:" << rtmp_gop
+         << ", flv packets after attach:" << flv_packets << ", start with key:" << first_key << endl;
+    //补齐的gop与之后的gop
+    return !flv_cached && rtmp_gop && first_key && flv_packets > rtmp_gop ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iostream>
+#include "Http/FMP4MediaSourceMuxer.h"
+#include "Poller/EventPoller.h"
+#include "TestUtil.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+using namespace mediakit::test;
+
+/**
+ * 输入多个gop后检查fmp4直播源的gop缓存只保留最后一个gop
+ * @param mode 分片模式
+ * @param max_packets 一个gop最多对应的分片个数
+ */
+static bool testGopCache(MP4MuxerMemory::FragmentMode mode, int max_packets) {
+    static const int kGopCount = 20;
+    auto stream_id = "gop_" + to_string(mode);
+
+    auto muxer = std::make_shared<FMP4MediaSourceMuxer>(DEFAULT_VHOST, "live", stream_id);
+    muxer->setFragmentMode(mode, 200);
+    muxer->addTrack(makeH264Track());
+    muxer->onAllTrackReady();
+    int index = 0;
+    for (int i = 0; i < kGopCount; ++i) {
+        inputGop(muxer, index);
+    }
+
+    auto src = dynamic_pointer_cast<FMP4MediaSource>(MediaSource::find(FMP4_SCHEMA, DEFAULT_VHOST, "live", stream_id));
+    if (!src) {
+        cerr << "fmp4 source not found, mode:" << mode << endl;
+        return false;
+    }
+    int packets = 0;
+    bool first_key = false;
+    auto poller = EventPollerPool::Instance().getPoller();
+    poller->sync([&]() {
+        auto reader = src->getRing()->attach(poller);
+        reader->setReadKeyCB([&](const FMP4MediaSource::RingDataType &list, bool is_key) {
+            if (!packets) {
+                first_key = is_key;
+            }
+            packets += list->size();
+        });
+    });
+    cout << "mode:" << mode << ", gop cache packets:" << packets << ", start with key:" << first_key << endl;
+    return first_key && packets > 0 && packets <= max_packets;
+}
+
+int main() {
+    bool ok = true;
+    //每帧一个分片时，一个gop为25个分片
+    ok = testGopCache(MP4MuxerMemory::FragmentPerFrame, 25) && ok;
+    //200ms一个分片，一个gop为5个分片
+    ok = testGopCache(MP4MuxerMemory::FragmentDuration, 5) && ok;
+    //每个gop一个分片，所有分片都是关键帧
+    ok = testGopCache(MP4MuxerMemory::FragmentGop, 1) && ok;
+    return ok ? 0 : 1;
+}
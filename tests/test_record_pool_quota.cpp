@@ -0,0 +1,129 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <thread>
+#include <iostream>
+#include "Config.h"
+#include "Record/RecordPool.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+
+//200ms一个分片，5个分片一个gop
+static const uint32_t kFragmentMs = 200;
+static const int kGopFragments = 5;
+
+static FMP4Packet::Ptr makePacket(uint32_t stamp) {
+    List<Buffer::Ptr> segment;
+    segment.emplace_back(std::make_shared<BufferLikeString>(string(64, 'm')));
+    segment.emplace_back(std::make_shared<BufferLikeString>(string(4000, 'd')));
+    auto packet = std::make_shared<FMP4Packet>(std::move(segment));
+    packet->time_stamp = stamp;
+    return packet;
+}
+
+/**
+ * 从窗口中最老的关键帧读到最新处，检查分片连续且包含最新的分片
+ */
+static bool checkWindow(const RecordStream::Ptr &stream, uint32_t last_stamp, int min_fragments) {
+    RecordCursor cursor;
+    uint64_t start_utc;
+    if (!RecordPool::Instance().seek(stream, 0, cursor, start_utc)) {
+        cerr << stream->getStream() << " seek failed" << endl;
+        return false;
+    }
+    RecordFragment fragment;
+    uint32_t stamp = 0;
+    int count = 0;
+    for (; RecordPool::Instance().read(stream, cursor, fragment); ++cursor.index, ++count) {
+        if (count && fragment.packet->time_stamp != stamp + kFragmentMs) {
+            cerr << stream->getStream() << " fragment gap:" << stamp << " -> " << fragment.packet->time_stamp << endl;
+            return false;
+        }
+        stamp = fragment.packet->time_stamp;
+    }
+    if (count < min_fragments || stamp != last_stamp) {
+        cerr << stream->getStream() << " window fragments:" << count << ", last stamp:" << stamp << "/" << last_stamp << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 多路流共享内存上限，检查窗口不超过上限，且各流保留了最近的分片；
+ * 同时有一个时移游标从头开始慢速读取，检查切片被淘汰拆分时读取仍然连续
+ * @param name 流名前缀
+ * @param stream_count 流个数
+ * @param segment_seconds 切片时长
+ * @param quota_fragments 内存上限，以每路流的分片个数计
+ * @param min_fragments 每路流至少保留的分片个数
+ */
+static bool testQuota(const string &name, int stream_count, unsigned segment_seconds, int quota_fragments, int min_fragments) {
+    static const int kRounds = 200;
+    auto &pool = RecordPool::Instance();
+    ConfigInfo.record.segment_duration = segment_seconds;
+    ConfigInfo.record.memory_quota = (uint64_t) stream_count * quota_fragments * makePacket(0)->size();
+
+    vector<RecordStream::Ptr> streams;
+    for (int i = 0; i < stream_count; ++i) {
+        streams.emplace_back(pool.addStream(DEFAULT_VHOST, "record", name + to_string(i)));
+        pool.setInitSegment(streams.back(), "init");
+    }
+
+    RecordCursor cursor;
+    uint32_t read_stamp = 0;
+    bool ok = true;
+    uint64_t max_bytes = 0;
+    for (int round = 1; round <= kRounds && ok; ++round) {
+        for (auto &stream : streams) {
+            pool.inputFragment(stream, makePacket(round * kFragmentMs), round % kGopFragments == 1);
+            max_bytes = std::max(max_bytes, pool.getStatistic().window_bytes);
+        }
+        uint64_t start_utc;
+        if (round == 1 && !pool.seek(streams[0], 0, cursor, start_utc)) {
+            cerr << name << " seek failed" << endl;
+            ok = false;
+        }
+        //每3轮读取一次，游标落后于写入
+        RecordFragment fragment;
+        while (round % 3 == 0 && pool.read(streams[0], cursor, fragment)) {
+            if (fragment.packet->time_stamp != read_stamp + kFragmentMs) {
+                cerr << name << " cursor gap:" << read_stamp << " -> " << fragment.packet->time_stamp << endl;
+                ok = false;
+                break;
+            }
+            read_stamp = fragment.packet->time_stamp;
+            ++cursor.index;
+        }
+        //切片开始时间以毫秒为单位，避免各轮的分片时间相同
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+
+    auto statistic = pool.getStatistic();
+    cout << name << " streams:" << stream_count << ", segment:" << segment_seconds << "s, max window bytes:" << max_bytes
+         << ", quota:" << ConfigInfo.record.memory_quota << ", evictions:" << statistic.evictions << endl;
+    if (max_bytes > ConfigInfo.record.memory_quota) {
+        ok = false;
+    }
+    for (auto &stream : streams) {
+        ok = checkWindow(stream, kRounds * kFragmentMs, min_fragments) && ok;
+        pool.removeStream(stream);
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    //内存上限可以容纳每路流3个2秒的切片，淘汰最老的切片后每路流至少保留2个切片
+    ok = testQuota("short_", 20, 2, 30, 20) && ok;
+    //内存上限只有每路流3秒，10秒的切片在关键帧处拆分淘汰，至少保留最新的gop
+    ok = testQuota("long_", 20, 10, 15, kGopFragments) && ok;
+    return ok ? 0 : 1;
+}
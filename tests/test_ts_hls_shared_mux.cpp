@@ -0,0 +1,69 @@
+﻿/*
+ * Copyright (c) 2016 The ZLMediaKit project authors. All Rights Reserved.
+ *
+ * This file is part of ZLMediaKit(https://github.com/xiongziliang/ZLMediaKit).
+ *
+ * Use of this source code is governed by MIT license that can be found in the
+ * LICENSE file in the root of the source tree. All contributing project authors
+ * may be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <iostream>
+#include "Http/TSMediaSourceMuxer.h"
+#include "Poller/EventPoller.h"
+#include "TestUtil.h"
+using namespace std;
+using namespace toolkit;
+using namespace mediakit;
+using namespace mediakit::test;
+
+/**
+ * hls切片与http-ts共用一个ts复用器，检查两者都有输出
+ */
+int main() {
+    static const int kGopCount = 10;
+    auto hls = std::make_shared<HlsMediaSourceMuxer>(DEFAULT_VHOST, "live", "shared_ts");
+    auto muxer = std::make_shared<TSMediaSourceMuxer>(DEFAULT_VHOST, "live", "shared_ts", hls);
+    muxer->addTrack(makeH264Track());
+    int index = 0;
+    for (int i = 0; i < kGopCount; ++i) {
+        inputGop(muxer, index);
+    }
+
+    auto hls_src = dynamic_pointer_cast<HlsMediaSource>(MediaSource::find(HLS_SCHEMA, DEFAULT_VHOST, "live", "shared_ts"));
+    auto ts_src = dynamic_pointer_cast<TSMediaSource>(MediaSource::find(TS_SCHEMA, DEFAULT_VHOST, "live", "shared_ts"));
+    if (!hls_src || !ts_src) {
+        cerr << "source not found, hls:" << !!hls_src << ", ts:" << !!ts_src << endl;
+        return 1;
+    }
+
+    //2秒一个切片，10秒的数据至少有3个完整切片
+    size_t segment_bytes = 0;
+    for (uint64_t seq = 0; seq < 3; ++seq) {
+        List<Buffer::Ptr> buffers;
+        if (!hls_src->getSegment(seq, -1, buffers)) {
+            cerr << "hls segment not found:" << seq << endl;
+            return 1;
+        }
+        buffers.for_each([&](const Buffer::Ptr &buf) {
+            segment_bytes += buf->size();
+        });
+    }
+
+    size_t ts_bytes = 0;
+    bool first_key = false;
+    auto poller = EventPollerPool::Instance().getPoller();
+    poller->sync([&]() {
+        auto reader = ts_src->getRing()->attach(poller);
+        reader->setReadKeyCB([&](const TSMediaSource::RingDataType &list, bool is_key) {
+            if (!ts_bytes) {
+                first_key = is_key;
+            }
+            list->for_each([&](const TSPacket::Ptr &packet) {
+                ts_bytes += packet->size();
+            });
+        });
+    });
+    cout << "hls segment bytes:" << segment_bytes << ", ts gop bytes:" << ts_bytes << ", start with key:" << first_key << endl;
+    return segment_bytes && segment_bytes % 188 == 0 && ts_bytes && ts_bytes % 188 == 0 && first_key ? 0 : 1;
+}